@@ -70,16 +70,10 @@ void lightPixel(byte x, byte y) {
 // turn on the pins to light a LED
 void LEDon(byte vin, byte gnd) {
   delay(1);
-  pinMode(0, INPUT); 
-  pinMode(1, INPUT); 
-  pinMode(2, INPUT); 
-  pinMode(3, INPUT); 
-  pinMode(4, INPUT); 
-
-  pinMode(vin, OUTPUT);   
-  pinMode(gnd, OUTPUT); 
-  digitalWrite(vin, HIGH);
-  digitalWrite(gnd, LOW); 
+  // all the pins float, then vin high and gnd low, driven together
+  portMode(PORT_B_ID, 0b11111, INPUT);
+  portWrite(PORT_B_ID, bit(vin) | bit(gnd), bit(vin));
+  portMode(PORT_B_ID, bit(vin) | bit(gnd), OUTPUT);
 }
 
 // runs at start
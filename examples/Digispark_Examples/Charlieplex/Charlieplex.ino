@@ -49,15 +49,8 @@ void loop() {
 }
 
 void LEDon(int vin, int gnd) {
-  pinMode(0, INPUT); 
-  pinMode(1, INPUT); 
-  pinMode(2, INPUT); 
-  pinMode(3, INPUT); 
-  pinMode(4, INPUT); 
-  pinMode(5, INPUT); 
-
-  pinMode(vin, OUTPUT);   
-  pinMode(gnd, OUTPUT); 
-  digitalWrite(vin, HIGH);
-  digitalWrite(gnd, LOW); 
+  // all the pins float, then vin high and gnd low, driven together
+  portMode(PORT_B_ID, 0b111111, INPUT);
+  portWrite(PORT_B_ID, bit(vin) | bit(gnd), bit(vin));
+  portMode(PORT_B_ID, bit(vin) | bit(gnd), OUTPUT);
 }
@@ -0,0 +1,133 @@
+/*
+  CoreBenchmark - measures the cost, in CPU cycles, of the hot core calls.
+
+  Each call is run BENCH_LOOPS times back to back and timed with the millis
+  timer (Timer1, one tick every 64 cycles on the Digispark), so the
+  resolution is 64 / BENCH_LOOPS cycles per call.  The cost of the empty
+  loop is measured first and subtracted from every result.  The millis
+  overflow interrupt still runs (about 60 cycles every 16384), which adds
+  well under 1% to each figure.
+
+  Results are written to Serial (TinyDebugSerial on PB2, 115200 baud) as
+  "name: cycles" lines, once at power up.  Keep a copy of the output from
+  a known good build and compare it after changing the core.
+
+  Pins used: PB1 (LED) for the digital calls, ADC2 (PB4) for analogRead.
+  The "(k)" lines use a constant pin number and so measure the inline fast
+  path from core_digital.h; the others go through wiring_digital.c.  The
+  "old" lines run the divide-per-digit number conversion Print used before
+  so the two can be compared on the same chip.
+*/
+
+#define BENCH_LOOPS     256
+#define BENCH_PIN       1
+#define BENCH_ADC       2
+
+// A Print that throws everything away so print() only costs the formatting.
+class NullPrint : public Print
+{
+  public:
+    virtual size_t write( uint8_t ) { return( 1 ); }
+};
+
+static NullPrint nullPrint;
+
+// The divide-per-digit conversion Print used to do, kept as the reference
+// for the "old" lines.
+static void oldPrintNumber( Print& p, unsigned long n, uint8_t base )
+{
+  char buf[8 * sizeof(long)];
+  uint8_t i = 0;
+
+  do
+  {
+    uint8_t digit = n % base;
+    n /= base;
+    buf[i++] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  }
+  while ( n > 0 );
+
+  while ( i > 0 )
+    p.write( buf[--i] );
+}
+
+static volatile unsigned long sinkLong;
+static volatile int sinkInt;
+static volatile uint8_t benchPin = BENCH_PIN;  // defeats the constant-pin fast path
+static unsigned long loopTicks;
+
+#define BENCH_RUN(result, stmt)                       \
+  do {                                                \
+    unsigned long _start = ticks();                   \
+    for ( uint16_t _i = 0; _i < BENCH_LOOPS; ++_i )   \
+    {                                                 \
+      stmt;                                           \
+      asm volatile ( "" ::: "memory" );               \
+    }                                                 \
+    result = ticks() - _start;                        \
+  } while ( 0 )
+
+#define BENCH(name, stmt)                             \
+  do {                                                \
+    unsigned long _ticks;                             \
+    BENCH_RUN( _ticks, stmt );                        \
+    report( F(name), _ticks );                        \
+  } while ( 0 )
+
+static void report( fstr_t* name, unsigned long elapsed )
+{
+  // cycles per call, in hundredths, with the empty loop taken out
+  unsigned long centi = 0;
+  if ( elapsed > loopTicks )
+    centi = ((elapsed - loopTicks) * clockCyclesPerTick() * 100UL) / BENCH_LOOPS;
+
+  Serial.print( name );
+  Serial.print( ": " );
+  Serial.print( centi / 100 );
+  Serial.print( '.' );
+  if ( (centi % 100) < 10 )
+    Serial.print( '0' );
+  Serial.println( centi % 100 );
+}
+
+void setup()
+{
+  Serial.begin( 115200 );
+  pinMode( BENCH_PIN, OUTPUT );
+
+  BENCH_RUN( loopTicks, (void)0 );
+
+  Serial.print( F("F_CPU: ") );
+  Serial.println( F_CPU );
+  Serial.print( F("loops: ") );
+  Serial.println( (unsigned long)BENCH_LOOPS );
+
+  BENCH( "digitalWrite",    digitalWrite( benchPin, _i & 1 ) );
+  BENCH( "digitalRead",     sinkInt = digitalRead( benchPin ) );
+  BENCH( "pinMode",         pinMode( benchPin, OUTPUT ) );
+  BENCH( "digitalWrite(k)", digitalWrite( BENCH_PIN, _i & 1 ) );
+  BENCH( "digitalRead(k)",  sinkInt = digitalRead( BENCH_PIN ) );
+  BENCH( "pinMode(k)",      pinMode( BENCH_PIN, OUTPUT ) );
+  BENCH( "analogRead",      sinkInt = analogRead( BENCH_ADC ) );
+  BENCH( "millis",          sinkLong = millis() );
+  BENCH( "micros",          sinkLong = micros() );
+  BENCH( "micros16",        sinkInt = micros16() );
+  BENCH( "ticks",           sinkLong = ticks() );
+  BENCH( "print(0UL)",      nullPrint.print( 0UL ) );
+  BENCH( "print(65535UL)",  nullPrint.print( 65535UL ) );
+  BENCH( "print(~0UL)",     nullPrint.print( 0xFFFFFFFFUL ) );
+  BENCH( "old(~0UL)",       oldPrintNumber( nullPrint, 0xFFFFFFFFUL, 10 ) );
+  BENCH( "print(millis)",   nullPrint.print( 3600000UL + _i ) );
+  BENCH( "old(millis)",     oldPrintNumber( nullPrint, 3600000UL + _i, 10 ) );
+  BENCH( "print(~0UL,HEX)", nullPrint.print( 0xFFFFFFFFUL, HEX ) );
+  BENCH( "old(~0UL,HEX)",   oldPrintNumber( nullPrint, 0xFFFFFFFFUL, 16 ) );
+  BENCH( "printFixed",      nullPrint.printFixed( 314159L, 4 ) );
+  BENCH( "print(3.14159)",  nullPrint.print( 3.14159, 4 ) );
+  BENCH( "print(str)",      nullPrint.print( "Digispark" ) );
+
+  Serial.println( F("done") );
+}
+
+void loop()
+{
+}
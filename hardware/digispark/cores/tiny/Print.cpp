@@ -21,33 +21,108 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <math.h>
 
 #include "wiring.h"
 #include "Print.h"
 
-// Public Methods //////////////////////////////////////////////////////////////
+/*
+  None of the tiny processors can divide (and the ATtiny85 can't multiply
+  either) so the n % 10, n /= 10 per digit of the original printNumber was
+  two calls to a 32 bit software divide, several hundred cycles each.
+  Decimal conversion subtracts powers of ten instead: at most nine
+  subtractions per digit, switching to 16 bit arithmetic once what is left
+  fits.  The digits come out most significant first.
+*/
+static const unsigned long powersOfTen[] PROGMEM =
+{
+  1UL, 10UL, 100UL, 1000UL, 10000UL,
+  100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
 
-/* default implementation: may be overridden */
-void Print::write(const char *str)
+// Writes at least width digits (with leading zeros) and returns the count
+static uint8_t formatDecimal(char *buf, unsigned long n, uint8_t width)
+{
+  char *p = buf;
+  uint8_t place;
+  unsigned long power;
+  unsigned int n16;
+  unsigned int power16;
+  char d;
+
+  for (place = 9; place >= 4; --place) {
+    power = pgm_read_dword(&powersOfTen[place]);
+    d = '0';
+    while (n >= power) {
+      n -= power;
+      ++d;
+    }
+    if (d != '0' || p != buf || place < width)
+      *p++ = d;
+  }
+
+  n16 = n;
+  for (place = 3; place >= 1; --place) {
+    power16 = pgm_read_word(&powersOfTen[place]);
+    d = '0';
+    while (n16 >= power16) {
+      n16 -= power16;
+      ++d;
+    }
+    if (d != '0' || p != buf || place < width)
+      *p++ = d;
+  }
+
+  *p++ = '0' + n16;
+  return p - buf;
+}
+
+// Writes the digits of n to buf (8 * sizeof(long) bytes) and returns the count
+static uint8_t formatNumber(char *buf, unsigned long n, uint8_t base)
 {
-  while (*str)
-    write(*str++);
+  char *end = buf + 8 * sizeof(long);
+  char *p = end;
+  unsigned char digit;
+  uint8_t shift;
+
+  if (base == 10)
+    return formatDecimal(buf, n, 1);
+
+  // the power of two bases are a mask and a shift per digit
+  shift = (base == 16) ? 4 : (base == 8) ? 3 : (base == 2) ? 1 : 0;
+
+  // build the digits backwards then move them to the front
+  do {
+    if (shift) {
+      digit = n & (base - 1);
+      n >>= shift;
+    } else {
+      digit = n % base;
+      n /= base;
+    }
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  } while (n > 0);
+
+  memmove(buf, p, end - p);
+  return end - p;
 }
 
+// Public Methods //////////////////////////////////////////////////////////////
+
 /* default implementation: may be overridden */
-void Print::write(const uint8_t *buffer, size_t size)
+size_t Print::write(const uint8_t *buffer, size_t size)
 {
+  size_t n = 0;
   while (size--)
-    write(*buffer++);
+    n += write(*buffer++);
+  return n;
 }
 
 void Print::print(const String &s)
 {
-  for (int i = 0; i < s.length(); i++) {
-    write(s[i]);
-  }
+  write(s.c_str(), s.length());
 }
 
 void Print::print(const char str[])
@@ -57,7 +132,8 @@ void Print::print(const char str[])
 
 void Print::print(char c, int base)
 {
-  print((long) c, base);
+  if (base == BYTE) write(c);
+  else print((long) c, base);
 }
 
 void Print::print(unsigned char b, int base)
@@ -103,26 +179,24 @@ void Print::print(double n, int digits)
 
 int Print::print( fstr_t* s )
 {
-  int rv;
-  char ch;
+  const char* p = (const char*) s;
+  return( printFlash( p, 0 ) );
+}
 
-  rv = 0;
-  ch = pgm_read_byte( s );
-  while ( ch != 0 )
-  {
-    write( ch );
-    ++s;
-    ++rv;
-    ch = pgm_read_byte( s );
+void Print::printFixed(long value, uint8_t decimals)
+{
+  unsigned long n = value;
+
+  if (value < 0) {
+    write('-');
+    n = -n;
   }
-  return( rv );
+  printFixedNumber(n, decimals);
 }
 
 int Print::println(void)
 {
-  print('\r');
-  print('\n');  
-  return( 2 );
+  return( write("\r\n", 2) );
 }
 
 void Print::println(const String &s)
@@ -188,27 +262,233 @@ int Print::println( fstr_t* s )
   return( rv );
 }
 
+void Print::printlnFixed(long value, uint8_t decimals)
+{
+  printFixed(value, decimals);
+  println();
+}
+
 // Private Methods /////////////////////////////////////////////////////////////
 
 void Print::printNumber(unsigned long n, uint8_t base)
 {
-  unsigned char buf[8 * sizeof(long)]; // Assumes 8-bit chars. 
-  unsigned long i = 0;
+  char buf[8 * sizeof(long)]; // Assumes 8-bit chars. 
 
-  if (n == 0) {
-    print('0');
-    return;
-  } 
+  write(buf, formatNumber(buf, n, base));
+}
+
+/*
+  Copies flash to the sink a few bytes at a time until a terminator or the
+  stop character.  p is left on whichever ended the run.
+*/
+#define PRINT_FLASH_CHUNK 16
 
-  while (n > 0) {
-    buf[i++] = n % base;
-    n /= base;
+int Print::printFlash( const char* &p, char stop )
+{
+  char buf[PRINT_FLASH_CHUNK];
+  uint8_t n;
+  int rv = 0;
+  char ch;
+
+  do
+  {
+    n = 0;
+    while ( n < sizeof(buf) && (ch = pgm_read_byte( p )) != 0 && ch != stop )
+    {
+      buf[n++] = ch;
+      ++p;
+    }
+    if ( n > 0 )
+    {
+      write( buf, n );
+      rv += n;
+    }
   }
+  while ( n == sizeof(buf) );
 
-  for (; i > 0; i--)
-    print((char) (buf[i - 1] < 10 ?
-      '0' + buf[i - 1] :
-      'A' + buf[i - 1] - 10));
+  return( rv );
+}
+
+int Print::pad( char c, int count )
+{
+  int rv = 0;
+
+  for ( ; count > 0; --count, ++rv )
+    write( c );
+  return( rv );
+}
+
+/*
+  A small printf.  The format is read from flash and the output goes
+  straight to the sink; literal text in chunks, each conversion as it is
+  reached, so nothing the size of the output is ever buffered.
+
+  %[-][0][width][l]c where c is one of d i u x X o b c s S (a string in
+  flash) or %.  Numbers are int unless l is given.
+*/
+int Print::printf( fstr_t* format, ... )
+{
+  va_list ap;
+  int rv;
+
+  va_start( ap, format );
+  rv = vprintf( format, ap );
+  va_end( ap );
+  return( rv );
+}
+
+int Print::vprintf( fstr_t* format, va_list ap )
+{
+  const char* p = (const char*) format;
+  char buf[8 * sizeof(long) + 1];
+  const char* str;
+  unsigned long n;
+  uint8_t left;
+  uint8_t zero;
+  uint8_t isLong;
+  uint8_t width;
+  uint8_t base;
+  size_t len;
+  char sign;
+  char ch;
+  int rv = 0;
+
+  for ( ;; )
+  {
+    rv += printFlash( p, '%' );
+    if ( pgm_read_byte( p ) == 0 )
+      break;
+    ++p;
+
+    left = zero = isLong = 0;
+    width = 0;
+    for ( ;; )
+    {
+      ch = pgm_read_byte( p++ );
+      if ( ch == '-' )
+        left = 1;
+      else if ( ch == '0' && width == 0 )
+        zero = 1;
+      else
+        break;
+    }
+    while ( ch >= '0' && ch <= '9' )
+    {
+      width = width * 10 + (ch - '0');
+      ch = pgm_read_byte( p++ );
+    }
+    if ( ch == 'l' )
+    {
+      isLong = 1;
+      ch = pgm_read_byte( p++ );
+    }
+
+    sign = 0;
+    str = buf;
+    switch ( ch )
+    {
+      case 'd':
+      case 'i':
+        if ( isLong )
+          n = va_arg( ap, long );
+        else
+          n = (long) va_arg( ap, int );
+        if ( (long) n < 0 )
+        {
+          sign = '-';
+          n = -n;
+        }
+        len = formatDecimal( buf, n, 1 );
+        break;
+
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'o':
+      case 'b':
+        if ( isLong )
+          n = va_arg( ap, unsigned long );
+        else
+          n = va_arg( ap, unsigned int );
+        base = (ch == 'u') ? 10 : (ch == 'o') ? 8 : (ch == 'b') ? 2 : 16;
+        len = formatNumber( buf, n, base );
+        if ( ch == 'x' )
+        {
+          for ( uint8_t i = 0; i < len; ++i )
+            if ( buf[i] >= 'A' )
+              buf[i] += 'a' - 'A';
+        }
+        break;
+
+      case 'c':
+        buf[0] = (char) va_arg( ap, int );
+        len = 1;
+        break;
+
+      case 's':
+        str = va_arg( ap, const char* );
+        if ( str == 0 )
+          str = "";
+        len = strlen( str );
+        break;
+
+      case 'S':
+        str = va_arg( ap, const char* );
+        len = strlen_P( str );
+        if ( ! left )
+          rv += pad( ' ', (int) width - (int) len );
+        rv += printFlash( str, 0 );
+        if ( left )
+          rv += pad( ' ', (int) width - (int) len );
+        continue;
+
+      case 0:
+        // a lone % at the end of the format
+        return( rv );
+
+      default:
+        // %% and anything unknown are written as is
+        buf[0] = ch;
+        len = 1;
+        break;
+    }
+
+    // the sign counts towards the width; zeros go between it and the digits
+    if ( sign )
+      ++len;
+    if ( ! left && ! zero )
+      rv += pad( ' ', (int) width - (int) len );
+    if ( sign )
+      rv += write( sign );
+    if ( ! left && zero )
+      rv += pad( '0', (int) width - (int) len );
+    rv += write( str, sign ? len - 1 : len );
+    if ( left )
+      rv += pad( ' ', (int) width - (int) len );
+  }
+
+  return( rv );
+}
+
+void Print::printFixedNumber(unsigned long n, uint8_t decimals)
+{
+  char buf[11]; // ten digits and the point
+  uint8_t count;
+  uint8_t whole;
+
+  if (decimals > 9)
+    decimals = 9;
+
+  // at least one digit in front of the point
+  count = formatDecimal(buf, n, decimals + 1);
+
+  if (decimals > 0) {
+    whole = count - decimals;
+    memmove(&buf[whole + 1], &buf[whole], decimals);
+    buf[whole] = '.';
+    ++count;
+  }
+  write(buf, count);
 }
 
 void Print::printFloat(double number, uint8_t digits) 
@@ -216,10 +496,22 @@ void Print::printFloat(double number, uint8_t digits)
   // Handle negative numbers
   if (number < 0.0)
   {
-     print('-');
+     write('-');
      number = -number;
   }
 
+  // While the scaled value is still an exact integer in a double (24 bits
+  // on the AVR) it can be rounded once and printed as fixed point.  That is
+  // a single multiply instead of a multiply, a conversion, a subtract, and
+  // a print for every digit.
+  if (digits <= 9) {
+    double scaled = number * pgm_read_dword(&powersOfTen[digits]) + 0.5;
+    if (scaled < 16777216.0) {
+      printFixedNumber((unsigned long) scaled, digits);
+      return;
+    }
+  }
+
   // Round correctly so that print(1.999, 2) prints as "2.00"
   double rounding = 0.5;
   for (uint8_t i=0; i<digits; ++i)
@@ -234,7 +526,7 @@ void Print::printFloat(double number, uint8_t digits)
 
   // Print the decimal point, but only if there are digits beyond
   if (digits > 0)
-    print("."); 
+    write('.');
 
   // Extract digits from the remainder one at a time
   while (digits-- > 0)
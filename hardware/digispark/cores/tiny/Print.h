@@ -27,6 +27,8 @@
 
 #include <inttypes.h>
 #include <stdio.h> // for size_t
+#include <stdarg.h>
+#include <string.h>
 #include <avr/pgmspace.h>
 
 #include "WString.h"
@@ -51,28 +53,27 @@ public:
 
 /* ...Printable */
     
-typedef struct
-{
-  char c;
-}
-fstr_t;
-
-/* rmv: Use the macro below in preparation for the next Arduino release.
-# define FSTR(s) ((fstr_t*)PSTR(s))
-*/
-# define F(s) ((fstr_t*)PSTR(s))
+/* fstr_t and F() are in WString.h */
 
 class Print
 {
   private:
     void printNumber(unsigned long, uint8_t);
+    void printFixedNumber(unsigned long, uint8_t);
     void printFloat(double, uint8_t);
+    int printFlash(const char* &, char);
+    int pad(char, int);
   protected:
     void setWriteError(int err = 1) { /*write_error = err;*/ }
   public:
     virtual size_t write(uint8_t) = 0;
-    virtual void write(const char *str);
-    virtual void write(const uint8_t *buffer, size_t size);
+    /* Everything below funnels into the buffer write so a sink that
+       overrides it handles a whole run at once. */
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *buffer, size_t size)
+    { return write((const uint8_t *)buffer, size); }
+    size_t write(const char *str)
+    { return write((const uint8_t *)str, strlen(str)); }
     
     void print(const String &);
     void print(const char[]);
@@ -84,6 +85,12 @@ class Print
     void print(unsigned long, int = DEC);
     void print(double, int = 2);
     int  print( fstr_t* );
+    /* value / 10^decimals with exactly that many decimals (0 to 9) without
+       any floating point; printFixed(-314, 2) prints -3.14 */
+    void printFixed(long value, uint8_t decimals);
+    /* printf(F("t=%lu ms\n"), millis()); see Print.cpp for what is supported */
+    int  printf( fstr_t* format, ... );
+    int  vprintf( fstr_t* format, va_list ap );
 
     void println(const String &s);
     void println(const char[]);
@@ -95,6 +102,7 @@ class Print
     void println(unsigned long, int = DEC);
     void println(double, int = 2);
     int  println( fstr_t* );
+    void printlnFixed(long value, uint8_t decimals);
     int  println(void);
   public:
     /* Printable...*/
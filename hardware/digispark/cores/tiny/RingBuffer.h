@@ -0,0 +1,319 @@
+/*==============================================================================
+
+  RingBuffer.h - Byte queue for one producer and one consumer.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#ifndef RingBuffer_h
+#define RingBuffer_h
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+
+
+/*=============================================================================
+  The producer (an interrupt, say) calls push, the consumer (the sketch)
+  calls pop, and neither has to turn interrupts off.  SIZE is a power of
+  two no bigger than 128.  head and tail count bytes in and out, wrap at
+  256 and are masked when used, so all SIZE bytes can be filled and each
+  side reads the other's counter in one instruction.  Only push writes
+  _head and only pop (and clear) writes _tail.
+
+  The barriers keep the compiler from moving the buffer access past the
+  counter update: a byte is stored before it's published and read before
+  its slot is given back.
+
+  A global or static RingBuffer starts out empty.  Anywhere else, call
+  clear() first.
+=============================================================================*/
+
+#define RING_BUFFER_BARRIER()     __asm__ __volatile__ ( "" ::: "memory" )
+
+template <uint8_t SIZE>
+class RingBuffer
+{
+  // Fails to compile for a bad SIZE
+  typedef char size_has_to_be_a_power_of_two_up_to_128
+      [ ((SIZE & (SIZE - 1)) == 0) && (SIZE > 0) && (SIZE <= 128) ? 1 : -1 ];
+
+  enum { MASK = SIZE - 1 };
+
+public:
+
+  uint8_t available( void ) const
+  {
+    return( (uint8_t)(_head - _tail) );
+  }
+
+  uint8_t room( void ) const
+  {
+    return( SIZE - available() );
+  }
+
+  bool isEmpty( void ) const
+  {
+    return( _head == _tail );
+  }
+
+  bool isFull( void ) const
+  {
+    return( available() == SIZE );
+  }
+
+  /*---------------------------------------------------------------------------
+    Producer
+  ---------------------------------------------------------------------------*/
+
+  bool push( uint8_t value )
+  {
+    uint8_t head = _head;
+
+    if ( (uint8_t)(head - _tail) == SIZE )
+      return( false );
+
+    _buffer[head & MASK] = value;
+    RING_BUFFER_BARRIER();
+    _head = head + 1;
+    return( true );
+  }
+
+  // As much of data as fits; returns how much that was
+  uint8_t push( const uint8_t* data, size_t count )
+  {
+    uint8_t head = _head;
+    uint8_t space = SIZE - (uint8_t)(head - _tail);
+    uint8_t index;
+    uint8_t run;
+
+    if ( count > space )
+      count = space;
+
+    // up to the end of the array, then again from the start
+    index = head & MASK;
+    run = SIZE - index;
+    if ( run > count )
+      run = count;
+    memcpy( &_buffer[index], data, run );
+    memcpy( &_buffer[0], data + run, count - run );
+
+    RING_BUFFER_BARRIER();
+    _head = head + (uint8_t) count;
+    return( (uint8_t) count );
+  }
+
+  /*---------------------------------------------------------------------------
+    Consumer
+  ---------------------------------------------------------------------------*/
+
+  // -1 when empty
+  int pop( void )
+  {
+    uint8_t tail = _tail;
+    uint8_t value;
+
+    if ( tail == _head )
+      return( -1 );
+
+    RING_BUFFER_BARRIER();
+    value = _buffer[tail & MASK];
+    RING_BUFFER_BARRIER();
+    _tail = tail + 1;
+    return( value );
+  }
+
+  // Up to count bytes; returns how many
+  uint8_t pop( uint8_t* data, size_t count )
+  {
+    uint8_t tail = _tail;
+    uint8_t waiting = (uint8_t)(_head - tail);
+    uint8_t index;
+    uint8_t run;
+
+    if ( count > waiting )
+      count = waiting;
+
+    RING_BUFFER_BARRIER();
+    index = tail & MASK;
+    run = SIZE - index;
+    if ( run > count )
+      run = count;
+    memcpy( data, &_buffer[index], run );
+    memcpy( data + run, &_buffer[0], count - run );
+
+    RING_BUFFER_BARRIER();
+    _tail = tail + (uint8_t) count;
+    return( (uint8_t) count );
+  }
+
+  int peek( void ) const
+  {
+    uint8_t tail = _tail;
+
+    if ( tail == _head )
+      return( -1 );
+
+    RING_BUFFER_BARRIER();
+    return( _buffer[tail & MASK] );
+  }
+
+  // Drops whatever is waiting
+  void clear( void )
+  {
+    _tail = _head;
+  }
+
+private:
+
+  uint8_t             _buffer[SIZE];
+  volatile uint8_t    _head;
+  volatile uint8_t    _tail;
+};
+
+
+/*=============================================================================
+  The same queue over a buffer the caller supplies, for when the size is
+  only known at run time (RcTxSerial takes it from its constructor).
+  begin hands over the buffer and its size, a power of two no bigger than
+  128.  A size of 0 (malloc failed, say) makes a queue that is always both
+  empty and full.  There is no constructor; call begin before anything
+  else.
+=============================================================================*/
+
+class ExternalRingBuffer
+{
+public:
+
+  void begin( uint8_t* buffer, uint8_t size )
+  {
+    _buffer = buffer;
+    _size = size;
+    _head = 0;
+    _tail = 0;
+  }
+
+  uint8_t available( void ) const
+  {
+    return( (uint8_t)(_head - _tail) );
+  }
+
+  uint8_t room( void ) const
+  {
+    return( _size - available() );
+  }
+
+  bool isEmpty( void ) const
+  {
+    return( _head == _tail );
+  }
+
+  bool isFull( void ) const
+  {
+    return( available() == _size );
+  }
+
+  /*---------------------------------------------------------------------------
+    Producer
+  ---------------------------------------------------------------------------*/
+
+  bool push( uint8_t value )
+  {
+    uint8_t head = _head;
+
+    if ( (uint8_t)(head - _tail) == _size )
+      return( false );
+
+    _buffer[head & (uint8_t)(_size - 1)] = value;
+    RING_BUFFER_BARRIER();
+    _head = head + 1;
+    return( true );
+  }
+
+  // As much of data as fits; returns how much that was
+  uint8_t push( const uint8_t* data, size_t count )
+  {
+    uint8_t head = _head;
+    uint8_t space = _size - (uint8_t)(head - _tail);
+    uint8_t index;
+    uint8_t run;
+
+    if ( count > space )
+      count = space;
+    if ( count == 0 )
+      return( 0 );
+
+    // up to the end of the array, then again from the start
+    index = head & (uint8_t)(_size - 1);
+    run = _size - index;
+    if ( run > count )
+      run = count;
+    memcpy( &_buffer[index], data, run );
+    memcpy( &_buffer[0], data + run, count - run );
+
+    RING_BUFFER_BARRIER();
+    _head = head + (uint8_t) count;
+    return( (uint8_t) count );
+  }
+
+  /*---------------------------------------------------------------------------
+    Consumer
+  ---------------------------------------------------------------------------*/
+
+  // -1 when empty
+  int pop( void )
+  {
+    uint8_t tail = _tail;
+    uint8_t value;
+
+    if ( tail == _head )
+      return( -1 );
+
+    RING_BUFFER_BARRIER();
+    value = _buffer[tail & (uint8_t)(_size - 1)];
+    RING_BUFFER_BARRIER();
+    _tail = tail + 1;
+    return( value );
+  }
+
+  int peek( void ) const
+  {
+    uint8_t tail = _tail;
+
+    if ( tail == _head )
+      return( -1 );
+
+    RING_BUFFER_BARRIER();
+    return( _buffer[tail & (uint8_t)(_size - 1)] );
+  }
+
+  // Drops whatever is waiting
+  void clear( void )
+  {
+    _tail = _head;
+  }
+
+private:
+
+  uint8_t*            _buffer;
+  uint8_t             _size;
+  volatile uint8_t    _head;
+  volatile uint8_t    _tail;
+};
+
+
+#endif
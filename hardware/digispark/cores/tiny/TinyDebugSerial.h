@@ -29,6 +29,7 @@
 #include "binary.h"
 #include "core_build_options.h"
 #include "Stream.h"
+#include "UserTimer.h"
 
 
 class TinyDebugSerialWriter;
@@ -47,6 +48,77 @@ class TinyDebugSerialWriter
     {
     }
 
+    // Each writer repeats this with a direct call to its own write so the
+    // bit banging is inlined in the loop; one virtual call per run instead
+    // of two per byte.
+    virtual void write( const uint8_t*, size_t )
+    {
+    }
+
+    // Only the buffered writer has anything to wait for or give back.
+    virtual void flush( void )
+    {
+    }
+
+    virtual void end( void )
+    {
+    }
+
+  friend class TinyDebugSerial;
+};
+
+
+/*=============================================================================
+  Buffered writer.  write puts the byte in a ring buffer and returns; the
+  user timer runs in CTC mode at the bit rate and its compare interrupt
+  sends one bit per match.  Interrupts are never off for more than a few
+  cycles so USB and millis are not disturbed.  The price is the user timer
+  (tone, and analogWrite on its two pins, can't be used until Serial.end;
+  the compare interrupt is passed on by Tone.cpp) and an interrupt per bit (at 115200 on a 16.5 MHz Digispark that is a
+  good part of the processor while bytes are going out).
+
+  The prescaler and compare value are picked by the compiler from the baud
+  rate passed to Serial.beginBuffered.  When the buffer is full write waits
+  for room; with interrupts off (in an ISR) the byte is dropped instead.
+=============================================================================*/
+
+#define TINY_DEBUG_SERIAL_DIVISOR(baud,n)   ( (F_CPU + (unsigned long)(baud) * USERTIMER_(PRESCALER_VALUE_##n) / 2) / ((unsigned long)(baud) * USERTIMER_(PRESCALER_VALUE_##n)) )
+#define TINY_DEBUG_SERIAL_FITS(baud,n)      ( TINY_DEBUG_SERIAL_DIVISOR( baud, n ) <= (unsigned long) USERTIMER_(MAXIMUM_OCR) + 1 )
+
+#define TINY_DEBUG_SERIAL_PRESCALE_INDEX(baud)  ( \
+    TINY_DEBUG_SERIAL_FITS( baud, 1 ) ? 1 : \
+    TINY_DEBUG_SERIAL_FITS( baud, 2 ) ? 2 : \
+    TINY_DEBUG_SERIAL_FITS( baud, 3 ) ? 3 : \
+    TINY_DEBUG_SERIAL_FITS( baud, 4 ) ? 4 : 5 )
+
+#define TINY_DEBUG_SERIAL_OCR(baud)  ( \
+    TINY_DEBUG_SERIAL_FITS( baud, 1 ) ? TINY_DEBUG_SERIAL_DIVISOR( baud, 1 ) - 1 : \
+    TINY_DEBUG_SERIAL_FITS( baud, 2 ) ? TINY_DEBUG_SERIAL_DIVISOR( baud, 2 ) - 1 : \
+    TINY_DEBUG_SERIAL_FITS( baud, 3 ) ? TINY_DEBUG_SERIAL_DIVISOR( baud, 3 ) - 1 : \
+    TINY_DEBUG_SERIAL_FITS( baud, 4 ) ? TINY_DEBUG_SERIAL_DIVISOR( baud, 4 ) - 1 : \
+                                        TINY_DEBUG_SERIAL_DIVISOR( baud, 5 ) - 1 )
+
+class TinyDebugSerialWriterBuffered : public TinyDebugSerialWriter
+{
+  public:
+
+    inline void configure( usertimer_(ocr_t) ocr, uint8_t csi )
+    {
+      _ocr = ocr;
+      _csi = csi;
+    }
+
+  protected:
+
+    usertimer_(ocr_t) _ocr;
+    uint8_t _csi;
+
+    virtual void init( void );
+    virtual void write( uint8_t value );
+    virtual void write( const uint8_t* buffer, size_t size );
+    virtual void flush( void );
+    virtual void end( void );
+
   friend class TinyDebugSerial;
 };
 
@@ -206,6 +278,12 @@ class TinyDebugSerialWriter_1_9600 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B00100, B00010, 0, 28, 2 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_1_9600::write( *buffer++ );
+    }
 };
 
 
@@ -236,6 +314,12 @@ class TinyDebugSerialWriter_1_38400 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B00000, B00000, 0, 2, 0 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_1_38400::write( *buffer++ );
+    }
 };
 
 
@@ -405,6 +489,12 @@ class TinyDebugSerialWriter_1_115200 : public TinyDebugSerialWriter
           [serbit] "I" ( SER_BIT )
       );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_1_115200::write( *buffer++ );
+    }
 };
 
 
@@ -435,6 +525,12 @@ class TinyDebugSerialWriter_8_9600 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B01001, B00100, 3, 89, 0 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_8_9600::write( *buffer++ );
+    }
 };
 
 
@@ -465,6 +561,12 @@ class TinyDebugSerialWriter_8_38400 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B01001, B00100, 0, 62, 2 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_8_38400::write( *buffer++ );
+    }
 };
 
 
@@ -495,6 +597,12 @@ class TinyDebugSerialWriter_8_115200 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B01010, B10100, 0, 16, 1 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_8_115200::write( *buffer++ );
+    }
 };
 
 
@@ -525,6 +633,12 @@ class TinyDebugSerialWriter_16_9600 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B10110, B11011, 6, 90, 2 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_16_9600::write( *buffer++ );
+    }
 };
 
 
@@ -555,6 +669,12 @@ class TinyDebugSerialWriter_16_38400 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B10110, B11011, 5, 25, 1 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_16_38400::write( *buffer++ );
+    }
 };
 
 
@@ -585,6 +705,12 @@ class TinyDebugSerialWriter_16_115200 : public TinyDebugSerialWriter
     {
       TinyDebugSerialWriterBangOneByte( value, SER_REG, SER_BIT, B11110, B11111, 0, 39, 1 );
     }
+
+    virtual void write( const uint8_t* buffer, size_t size )
+    {
+      while ( size-- )
+        TinyDebugSerialWriter_16_115200::write( *buffer++ );
+    }
 };
 
 
@@ -662,6 +788,7 @@ class TinyDebugSerialWriter_16_115200 : public TinyDebugSerialWriter
 extern TinyDebugSerialWriter_9600 tdsw9600;
 extern TinyDebugSerialWriter_38400 tdsw38400;
 extern TinyDebugSerialWriter_115200 tdsw115200;
+extern TinyDebugSerialWriterBuffered tdswBuffered;
 
 void TinyDebugSerialBadBaud( void ) __attribute__((error("Serial (TinyDebugSerial) supports three baud rates: 9600, 38400, or 115200.")));
 void TinyDebugSerialBaudMustBeConstant( void ) __attribute__((error("The baud rate for Serial (TinyDebugSerial) cannot be changed at run-time.  Use 9600, 38400, or 115200.")));
@@ -706,8 +833,24 @@ class TinyDebugSerial : public Stream
       _writer->init();
     }
 
+    // Any baud rate the user timer can reach; see TinyDebugSerialWriterBuffered
+    inline void beginBuffered( long baud )
+    {
+      if ( __builtin_constant_p( baud ) )
+      {
+        tdswBuffered.configure( TINY_DEBUG_SERIAL_OCR( baud ), TINY_DEBUG_SERIAL_PRESCALE_INDEX( baud ) );
+        _writer = &tdswBuffered;
+      }
+      else
+      {
+        TinyDebugSerialBaudMustBeConstant();
+      }
+      _writer->init();
+    }
+
     void end( void )
     {
+      _writer->end();
       useStub();
     }
 
@@ -728,6 +871,7 @@ class TinyDebugSerial : public Stream
 
     virtual void flush( void )
     {
+      _writer->flush();
     }
 
     virtual size_t write( uint8_t c )
@@ -736,6 +880,12 @@ class TinyDebugSerial : public Stream
       return( 1 );
     }
 
+    virtual size_t write( const uint8_t* buffer, size_t size )
+    {
+      _writer->write( buffer, size );
+      return( size );
+    }
+
     using Print::write; // pull in write(str) and write(buf, size) from Print
 };
 
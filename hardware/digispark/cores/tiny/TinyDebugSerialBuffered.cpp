@@ -0,0 +1,180 @@
+/*==============================================================================
+
+  TinyDebugSerialBuffered.cpp - Interrupt driven transmit for TinyDebugSerial.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+
+#include "core_build_options.h"
+#include "RingBuffer.h"
+#include "TinyDebugSerial.h"
+#include "ToneTimer.h"
+#include "UserTimer.h"
+#include "wiring.h"
+
+#if TINY_DEBUG_SERIAL_SUPPORTED
+
+#if TIMER_TO_USE_FOR_USER != TIMER_TO_USE_FOR_TONE
+  #error The buffered writer expects the user timer to be the tone timer.
+#endif
+
+#define TDS_PORT            _SFR_IO8( TINY_DEBUG_SERIAL_REGISTER )
+#define TDS_DDR             _SFR_IO8( TINY_DEBUG_SERIAL_REGISTER - 1 )
+
+static RingBuffer<TINY_DEBUG_SERIAL_BUFFER_SIZE> tds_ring;
+
+// Bits still to go out, least significant first; zero between bytes
+static uint16_t             tds_frame;
+static volatile uint8_t     tds_sending;
+static volatile uint8_t     tds_busy;
+
+TinyDebugSerialWriterBuffered tdswBuffered;
+
+// The compare match vector belongs to Tone.cpp; see tds_bit below
+extern void (* volatile tone_timer_hook)( void );
+
+static void tds_bit( void );
+
+
+void TinyDebugSerialWriterBuffered::init( void )
+{
+  uint8_t oldSREG;
+
+  // Idle is high
+  TDS_PORT |= _BV( TINY_DEBUG_SERIAL_BIT );
+  TDS_DDR |= _BV( TINY_DEBUG_SERIAL_BIT );
+
+  oldSREG = SREG;
+  cli();
+
+  tds_ring.clear();
+  tds_frame = 0;
+  tds_sending = 0;
+
+  UserTimer_SetToPowerup();
+  UserTimer_SetWaveformGenerationMode( UserTimer_(CTC_OCR) );
+  UserTimer_SetOutputCompareMatchAndClear( _ocr );
+  UserTimer_ClockSelect( (usertimer_(cs_t)) _csi );
+
+  tone_timer_hook = tds_bit;
+
+  SREG = oldSREG;
+}
+
+void TinyDebugSerialWriterBuffered::write( uint8_t value )
+{
+  uint8_t oldSREG;
+
+  while ( ! tds_ring.push( value ) )
+  {
+    // Nobody is going to make room
+    if ( (SREG & _BV( SREG_I )) == 0 )
+      return;
+  }
+
+  oldSREG = SREG;
+  cli();
+  if ( ! tds_sending )
+  {
+    tds_sending = 1;
+    // The timer has been matching all along; start a fresh bit period so
+    // the start bit is a full bit long
+    UserTimer_SetCount( 0 );
+    UserTimer_ClearOutputCompareMatchFlagA();
+    UserTimer_EnableOutputCompareInterruptA();
+  }
+  SREG = oldSREG;
+}
+
+void TinyDebugSerialWriterBuffered::write( const uint8_t* buffer, size_t size )
+{
+  while ( size-- )
+    TinyDebugSerialWriterBuffered::write( *buffer++ );
+}
+
+void TinyDebugSerialWriterBuffered::flush( void )
+{
+  while ( tds_sending )
+  {
+    if ( (SREG & _BV( SREG_I )) == 0 )
+      return;
+  }
+}
+
+void TinyDebugSerialWriterBuffered::end( void )
+{
+  flush();
+  UserTimer_InterruptsOff();
+  tone_timer_hook = 0;
+  initToneTimer();
+}
+
+
+/*=============================================================================
+  User timer compare match A; one per bit.  The start bit of a byte is a
+  few cycles later than the other edges (the byte has to be fetched first)
+  which is nothing next to a bit time.
+
+  The user timer is the tone timer so the vector itself is in Tone.cpp;
+  it calls this through tone_timer_hook while the writer is in use.  That
+  way a sketch can have both tone and beginBuffered (though not at once).
+
+  The handler runs with interrupts enabled so USB is never held off.  USB
+  can still delay an edge; should that run into the next bit the late
+  match is dropped rather than nesting.
+=============================================================================*/
+
+static void tds_bit( void )
+{
+  uint16_t frame;
+  int value;
+
+  if ( tds_busy )
+    return;
+  tds_busy = 1;
+
+  frame = tds_frame;
+
+  if ( frame == 0 )
+  {
+    value = tds_ring.pop();
+
+    if ( value < 0 )
+    {
+      UserTimer_InterruptsOff();
+      tds_sending = 0;
+      tds_busy = 0;
+      return;
+    }
+
+    // start bit, eight data bits, stop bit
+    frame = ((uint16_t) value << 1) | 0x200;
+  }
+
+  if ( frame & 1 )
+    TDS_PORT |= _BV( TINY_DEBUG_SERIAL_BIT );
+  else
+    TDS_PORT &= ~ _BV( TINY_DEBUG_SERIAL_BIT );
+
+  tds_frame = frame >> 1;
+  tds_busy = 0;
+}
+
+
+#endif
@@ -36,143 +36,65 @@ Version Modified By Date     Comments
 #define DEBUG_TONE 0
 
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include "core_build_options.h"
+#include "core_tone.h"
 #include "ToneTimer.h"
 #include "pins_arduino.h"
 #include "wiring.h"
 
-#if (TONETIMER_NUMBER_PRESCALERS != 5) && (TONETIMER_NUMBER_PRESCALERS != 15)
-#error Only five or fifteen prescalers are supported.  Update the code to support the number of actual prescalers.
-#endif
+const unsigned int Tone_Lowest_Frequency = TONE_LOWEST_FREQUENCY;
 
+/*
+  tone_cutoff[i] is the highest frequency for prescaler index i + 1 and
+  tone_shift[i] is log2 of that prescaler.  Scanning up from the smallest
+  prescaler takes a few flash reads instead of a chain of comparisons, and
+  the shift replaces the multiply by the prescaler.
+*/
 #if TONETIMER_NUMBER_PRESCALERS == 15
-#define TONETIMER_MAXIMUM_DIVISOR  ( (unsigned long)(TONETIMER_(PRESCALER_VALUE_15)) * (1L + (unsigned long)(TONETIMER_(MAXIMUM_OCR))) )
-#endif
-
-#if TONETIMER_NUMBER_PRESCALERS == 5
-#define TONETIMER_MAXIMUM_DIVISOR  ( (unsigned long)(TONETIMER_(PRESCALER_VALUE_5)) * (1L + (unsigned long)(TONETIMER_(MAXIMUM_OCR))) )
-#endif
 
-const unsigned int Tone_Lowest_Frequency = (F_CPU + (2L * TONETIMER_MAXIMUM_DIVISOR - 1L)) / (2L * TONETIMER_MAXIMUM_DIVISOR);
-
-#if (TONETIMER_(MAXIMUM_OCR) == 65535) && (TONETIMER_(PRESCALE_SET) == 1)
-#if F_CPU <= 1000000
-  #define TONE_FREQUENCY_CUTOFF_2  (7)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 8000000
-  #define TONE_FREQUENCY_CUTOFF_3  (7)
-  #define TONE_FREQUENCY_CUTOFF_2  (61)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 16000000
-  #define TONE_FREQUENCY_CUTOFF_4  (1)
-  #define TONE_FREQUENCY_CUTOFF_3  (15)
-  #define TONE_FREQUENCY_CUTOFF_2  (122)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 16500000
-  #define TONE_FREQUENCY_CUTOFF_4  (1)
-  #define TONE_FREQUENCY_CUTOFF_3  (15)
-  #define TONE_FREQUENCY_CUTOFF_2  (122)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#endif
-#endif
+static const uint16_t tone_cutoff[TONETIMER_NUMBER_PRESCALERS] PROGMEM =
+{
+  TONE_FREQUENCY_CUTOFF_1, TONE_FREQUENCY_CUTOFF_2, TONE_FREQUENCY_CUTOFF_3,
+  TONE_FREQUENCY_CUTOFF_4, TONE_FREQUENCY_CUTOFF_5, TONE_FREQUENCY_CUTOFF_6,
+  TONE_FREQUENCY_CUTOFF_7, TONE_FREQUENCY_CUTOFF_8, TONE_FREQUENCY_CUTOFF_9,
+  TONE_FREQUENCY_CUTOFF_10, TONE_FREQUENCY_CUTOFF_11, TONE_FREQUENCY_CUTOFF_12,
+  TONE_FREQUENCY_CUTOFF_13, TONE_FREQUENCY_CUTOFF_14, TONE_FREQUENCY_CUTOFF_15
+};
+
+static const uint8_t tone_shift[TONETIMER_NUMBER_PRESCALERS] PROGMEM =
+{
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_1) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_2) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_3) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_4) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_5) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_6) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_7) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_8) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_9) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_10) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_11) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_12) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_13) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_14) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_15) )
+};
+
+#else
+
+static const uint16_t tone_cutoff[TONETIMER_NUMBER_PRESCALERS] PROGMEM =
+{
+  TONE_FREQUENCY_CUTOFF_1, TONE_FREQUENCY_CUTOFF_2, TONE_FREQUENCY_CUTOFF_3,
+  TONE_FREQUENCY_CUTOFF_4, TONE_FREQUENCY_CUTOFF_5
+};
 
-#if (TONETIMER_(MAXIMUM_OCR) == 255) && (TONETIMER_(PRESCALE_SET) == 1)
-#if F_CPU <= 1000000
-  #define TONE_FREQUENCY_CUTOFF_5  (7)
-  #define TONE_FREQUENCY_CUTOFF_4  (30)
-  #define TONE_FREQUENCY_CUTOFF_3  (243)
-  #define TONE_FREQUENCY_CUTOFF_2  (1949)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 8000000
-  #define TONE_FREQUENCY_CUTOFF_5  (60)
-  #define TONE_FREQUENCY_CUTOFF_4  (243)
-  #define TONE_FREQUENCY_CUTOFF_3  (1949)
-  #define TONE_FREQUENCY_CUTOFF_2  (15594)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 16000000
-  #define TONE_FREQUENCY_CUTOFF_5  (121)
-  #define TONE_FREQUENCY_CUTOFF_4  (487)
-  #define TONE_FREQUENCY_CUTOFF_3  (3898)
-  #define TONE_FREQUENCY_CUTOFF_2  (31189)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 16500000
-  #define TONE_FREQUENCY_CUTOFF_5  (121)
-  #define TONE_FREQUENCY_CUTOFF_4  (487)
-  #define TONE_FREQUENCY_CUTOFF_3  (3898)
-  #define TONE_FREQUENCY_CUTOFF_2  (31189)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#endif
-#endif
+static const uint8_t tone_shift[TONETIMER_NUMBER_PRESCALERS] PROGMEM =
+{
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_1) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_2) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_3) ), TONE_LOG2( TONETIMER_(PRESCALER_VALUE_4) ),
+  TONE_LOG2( TONETIMER_(PRESCALER_VALUE_5) )
+};
 
-#if (TONETIMER_(MAXIMUM_OCR) == 255) && (TONETIMER_(PRESCALE_SET) == 2)
-#if F_CPU <= 1000000
-  #define TONE_FREQUENCY_CUTOFF_12 (1)
-  #define TONE_FREQUENCY_CUTOFF_11 (3)
-  #define TONE_FREQUENCY_CUTOFF_10 (7)
-  #define TONE_FREQUENCY_CUTOFF_9  (15)
-  #define TONE_FREQUENCY_CUTOFF_8  (30)
-  #define TONE_FREQUENCY_CUTOFF_7  (60)
-  #define TONE_FREQUENCY_CUTOFF_6  (121)
-  #define TONE_FREQUENCY_CUTOFF_5  (243)
-  #define TONE_FREQUENCY_CUTOFF_4  (487)
-  #define TONE_FREQUENCY_CUTOFF_3  (974)
-  #define TONE_FREQUENCY_CUTOFF_2  (1949)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 8000000
-  #define TONE_FREQUENCY_CUTOFF_15 (1)
-  #define TONE_FREQUENCY_CUTOFF_14 (3)
-  #define TONE_FREQUENCY_CUTOFF_13 (7)
-  #define TONE_FREQUENCY_CUTOFF_12 (15)
-  #define TONE_FREQUENCY_CUTOFF_11 (30)
-  #define TONE_FREQUENCY_CUTOFF_10 (60)
-  #define TONE_FREQUENCY_CUTOFF_9  (121)
-  #define TONE_FREQUENCY_CUTOFF_8  (243)
-  #define TONE_FREQUENCY_CUTOFF_7  (487)
-  #define TONE_FREQUENCY_CUTOFF_6  (974)
-  #define TONE_FREQUENCY_CUTOFF_5  (1949)
-  #define TONE_FREQUENCY_CUTOFF_4  (3898)
-  #define TONE_FREQUENCY_CUTOFF_3  (7797)
-  #define TONE_FREQUENCY_CUTOFF_2  (15594)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 16000000
-  #define TONE_FREQUENCY_CUTOFF_15 (3)
-  #define TONE_FREQUENCY_CUTOFF_14 (7)
-  #define TONE_FREQUENCY_CUTOFF_13 (15)
-  #define TONE_FREQUENCY_CUTOFF_12 (30)
-  #define TONE_FREQUENCY_CUTOFF_11 (60)
-  #define TONE_FREQUENCY_CUTOFF_10 (121)
-  #define TONE_FREQUENCY_CUTOFF_9  (243)
-  #define TONE_FREQUENCY_CUTOFF_8  (487)
-  #define TONE_FREQUENCY_CUTOFF_7  (974)
-  #define TONE_FREQUENCY_CUTOFF_6  (1949)
-  #define TONE_FREQUENCY_CUTOFF_5  (3898)
-  #define TONE_FREQUENCY_CUTOFF_4  (7797)
-  #define TONE_FREQUENCY_CUTOFF_3  (15594)
-  #define TONE_FREQUENCY_CUTOFF_2  (31189)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#elif F_CPU <= 16500000
-  #define TONE_FREQUENCY_CUTOFF_15 (3)
-  #define TONE_FREQUENCY_CUTOFF_14 (7)
-  #define TONE_FREQUENCY_CUTOFF_13 (15)
-  #define TONE_FREQUENCY_CUTOFF_12 (30)
-  #define TONE_FREQUENCY_CUTOFF_11 (60)
-  #define TONE_FREQUENCY_CUTOFF_10 (121)
-  #define TONE_FREQUENCY_CUTOFF_9  (243)
-  #define TONE_FREQUENCY_CUTOFF_8  (487)
-  #define TONE_FREQUENCY_CUTOFF_7  (974)
-  #define TONE_FREQUENCY_CUTOFF_6  (1949)
-  #define TONE_FREQUENCY_CUTOFF_5  (3898)
-  #define TONE_FREQUENCY_CUTOFF_4  (7797)
-  #define TONE_FREQUENCY_CUTOFF_3  (15594)
-  #define TONE_FREQUENCY_CUTOFF_2  (31189)
-  #define TONE_FREQUENCY_CUTOFF_1  (65535)
-#endif
 #endif
 
 
 #if DEBUG_TONE
 uint16_t debug_tone_last_OCRxA;
-uint16_t debug_tone_last_CSV;
+uint8_t debug_tone_last_CSI;
 #endif
 
 
@@ -187,13 +109,43 @@ static volatile uint8_t tone_timer_pin_mask;
 
 static uint8_t tone_pin = 255;
 
+// Set by the buffered TinyDebugSerial while it has the timer; the compare
+// match vector is shared so it is handed the interrupt instead
+void (* volatile tone_timer_hook)( void ) = 0;
+
 
-void tone( uint8_t _pin, unsigned int frequency, unsigned long duration )
+void toneVariable( uint8_t _pin, unsigned int frequency, unsigned long duration )
+{
+  uint8_t index;
+  unsigned long divisor;
+
+  if ( frequency == 0 )
+  {
+    toneStart( _pin, 0, duration, 0, 0 );
+    return;
+  }
+
+  if ( frequency < Tone_Lowest_Frequency )
+  {
+    frequency = Tone_Lowest_Frequency;
+  }
+
+  /* Determine which prescaler to use */
+  index = 1;
+  while ( (index < TONETIMER_NUMBER_PRESCALERS) && (frequency <= pgm_read_word( &tone_cutoff[index] )) )
+  {
+    ++index;
+  }
+
+  /* Set the Output Compare Register (rounding) */
+  divisor = (unsigned long) frequency << pgm_read_byte( &tone_shift[index - 1] );
+
+  toneStart( _pin, frequency, duration, index, (F_CPU / divisor + 1L) / 2L - 1L );
+}
+
+
+void toneStart( uint8_t _pin, unsigned int frequency, unsigned long duration, uint8_t csi, tonetimer_(ocr_t) ocr )
 {
-  tonetimer_(ocr_t)             ocr;
-  tonetimer_(prescale_value_t)  csv;
-  tonetimer_(cs_t)              csi;
-  
   if ( tone_pin == 255 )
   {
     /* Set the timer to power-up conditions so we start from a known state */
@@ -254,149 +206,11 @@ void tone( uint8_t _pin, unsigned int frequency, unsigned long duration )
 
     if ( frequency > 0 )
     {
-      if ( frequency < Tone_Lowest_Frequency )
-      {
-        frequency = Tone_Lowest_Frequency;
-      }
-
-      /* Determine which prescaler to use */
-      /* Set the Output Compare Register (rounding up) */
-
-      #if defined( TONE_FREQUENCY_CUTOFF_15 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_15 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_15);
-        csi = ToneTimer_(Prescale_Index_15);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_14 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_14 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_14);
-        csi = ToneTimer_(Prescale_Index_14);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_13 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_13 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_13);
-        csi = ToneTimer_(Prescale_Index_13);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_12 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_12 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_12);
-        csi = ToneTimer_(Prescale_Index_12);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_11 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_11 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_11);
-        csi = ToneTimer_(Prescale_Index_11);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_10 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_10 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_10);
-        csi = ToneTimer_(Prescale_Index_10);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_9 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_9 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_9);
-        csi = ToneTimer_(Prescale_Index_9);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_8 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_8 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_8);
-        csi = ToneTimer_(Prescale_Index_8);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_7 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_7 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_7);
-        csi = ToneTimer_(Prescale_Index_7);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_6 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_6 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_6);
-        csi = ToneTimer_(Prescale_Index_6);
-      }
-      else
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_5 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_5 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_5);
-        csi = ToneTimer_(Prescale_Index_5);
-      }
-      else 
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_4 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_4 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_4);
-        csi = ToneTimer_(Prescale_Index_4);
-      }
-      else 
-      #endif
-
-      #if defined( TONE_FREQUENCY_CUTOFF_3 )
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_3 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_3);
-        csi = ToneTimer_(Prescale_Index_3);
-      }
-      else
-      #endif
-
-      if ( frequency <= TONE_FREQUENCY_CUTOFF_2 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_2);
-        csi = ToneTimer_(Prescale_Index_2);
-      }
-
-      else // if ( frequency <= TONE_FREQUENCY_CUTOFF_1 )
-      {
-        csv = TONETIMER_(PRESCALER_VALUE_1);
-        csi = ToneTimer_(Prescale_Index_1);
-      }
-
-      ocr = ( (2L * F_CPU) / (frequency * 2L * csv) + 1L ) / 2L - 1L;
       ToneTimer_SetOutputCompareMatchAndClear( ocr );
 
       #if DEBUG_TONE
         debug_tone_last_OCRxA = ocr;
-        debug_tone_last_CSV = csv;
+        debug_tone_last_CSI = csi;
       #endif
 
       /* Does the caller want a specific duration? */
@@ -423,7 +237,7 @@ void tone( uint8_t _pin, unsigned int frequency, unsigned long duration )
 
       /* Start the clock... */
 
-      ToneTimer_ClockSelect( csi );
+      ToneTimer_ClockSelect( (tonetimer_(cs_t)) csi );
     }
     else
     {
@@ -479,6 +293,14 @@ void noTone( uint8_t _pin )
 
 ISR( TONETIMER_COMPA_vect, ISR_NOBLOCK )
 {
+  void (*hook)( void ) = tone_timer_hook;
+
+  if ( hook )
+  {
+    hook();
+    return;
+  }
+
   if ( tone_timer_toggle_count != 0 )
   {
     if ( tone_timer_toggle_count > 0 )
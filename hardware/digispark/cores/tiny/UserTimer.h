@@ -64,11 +64,17 @@
 #define UserTimer_SetCompareOutputModeA           UserTimer_(SetCompareOutputModeA)
 #define UserTimer_SetCompareOutputModeB           UserTimer_(SetCompareOutputModeB)
 #define UserTimer_SetOutputCompareMatchAndClear   UserTimer_(SetOutputCompareMatchAndClear)
+#define UserTimer_SetOutputCompareMatchA          UserTimer_(SetOutputCompareMatchA)
+#define UserTimer_SetOutputCompareMatchB          UserTimer_(SetOutputCompareMatchB)
+#define UserTimer_DisconnectOutputs               UserTimer_(DisconnectOutputs)
+#define UserTimer_OutputComparePinA               UserTimer_(OutputComparePinA)
+#define UserTimer_OutputComparePinB               UserTimer_(OutputComparePinB)
 #define UserTimer_EnableOutputCompareInterruptA   UserTimer_(EnableOutputCompareInterruptA)
 #define UserTimer_EnableOverflowInterrupt         UserTimer_(EnableOverflowInterrupt)
 #define UserTimer_GetCount                        UserTimer_(GetCount)
 #define UserTimer_SetCount                        UserTimer_(SetCount)
 #define UserTimer_IsOverflowSet                   UserTimer_(IsOverflowSet)
+#define UserTimer_ClearOutputCompareMatchFlagA   UserTimer_(ClearOutputCompareMatchFlagA)
 
 #define USERTIMER_OVF_vect                        USERTIMER_(OVF_vect)
 #define USERTIMER_COMPA_vect                      USERTIMER_(COMPA_vect)
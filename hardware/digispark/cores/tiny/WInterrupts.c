@@ -128,8 +128,27 @@ void detachInterrupt(uint8_t interruptNum)
 }
 
 #if NUMBER_EXTERNAL_INTERRUPTS >= 1
+/*
+  INT0 is shared.  Handlers defined with INT0_HANDLER (core_interrupts.h)
+  are called first, in slot order, then the attachInterrupt function which
+  has the last slot.  An empty slot is a weak symbol that resolves to zero.
+*/
+extern void int0Handler_0(void) __attribute__((weak));
+extern void int0Handler_1(void) __attribute__((weak));
+extern void int0Handler_2(void) __attribute__((weak));
+
+#if INTERRUPT_SLOT_ATTACH != 3
+#error Update the INT0 router for the number of slots.
+#endif
+
 ISR(EXTERNAL_INTERRUPT_0_vect, ISR_NOBLOCK)
 {
+  if(int0Handler_0)
+    int0Handler_0();
+  if(int0Handler_1)
+    int0Handler_1();
+  if(int0Handler_2)
+    int0Handler_2();
   if(intFunc[EXTERNAL_INTERRUPT_0])
     intFunc[EXTERNAL_INTERRUPT_0]();
 }
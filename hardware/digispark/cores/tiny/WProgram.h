@@ -17,6 +17,7 @@
 #include "WString.h"
 #include "TinyDebugSerial.h"
 #include "HardwareSerial.h"
+#include "core_tone.h"
 
 uint16_t makeWord(uint16_t w);
 uint16_t makeWord(byte h, byte l);
@@ -25,8 +26,15 @@ uint16_t makeWord(byte h, byte l);
 
 unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000L);
 
-void tone(uint8_t _pin, unsigned int frequency, unsigned long duration = 0);
-void noTone(uint8_t _pin = 255);
+// memoryStats as one line of text; works with DigiUSB, TinyDebugSerial, ...
+void memoryReport(Print& out);
+
+// Sampling profiler (wiring_profile.cpp).  first and last are flash byte
+// addresses; profileEnd returns nonzero if it was running.
+void profileBegin(uint16_t first = 0, uint16_t last = FLASHEND);
+uint8_t profileEnd(void);
+void profileResume(void);
+void profileReport(Print& out);
 
 // WMath prototypes
 long random(long);
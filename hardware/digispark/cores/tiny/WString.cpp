@@ -22,78 +22,257 @@
 #include "WString.h"
 
 
+/*
+  Buffers that don't fit inside the String are rounded up to a whole number
+  of STRING_ALLOC_UNIT bytes so growing a character or two at a time doesn't
+  allocate every time.
+*/
+#define STRING_ALLOC_UNIT 8
+
+#if STRING_ARENA_SIZE > 0
+
+/*
+  The arena is split into STRING_ALLOC_UNIT byte blocks with one bit per
+  block in string_arena_used.  A buffer is a run of consecutive blocks.
+  Memory use is bounded by the arena; an allocation that doesn't fit fails
+  and the String is left as it was.
+*/
+#define STRING_ARENA_BLOCKS (STRING_ARENA_SIZE / STRING_ALLOC_UNIT)
+
+static char string_arena[STRING_ARENA_BLOCKS * STRING_ALLOC_UNIT];
+static uint8_t string_arena_used[(STRING_ARENA_BLOCKS + 7) / 8];
+
+static uint8_t arenaIsUsed( unsigned int block )
+{
+  return string_arena_used[block / 8] & (1 << (block % 8));
+}
+
+static void arenaMark( unsigned int first, unsigned int count, uint8_t used )
+{
+  for ( ; count > 0; --count, ++first )
+  {
+    if ( used )
+      string_arena_used[first / 8] |= (1 << (first % 8));
+    else
+      string_arena_used[first / 8] &= ~(1 << (first % 8));
+  }
+}
+
+static char *stringAlloc( char *old, unsigned int oldCapacity, unsigned int &capacity )
+{
+  unsigned int blocks = (capacity + STRING_ALLOC_UNIT) / STRING_ALLOC_UNIT;
+  unsigned int first;
+  unsigned int run;
+  unsigned int i;
+
+  if ( old != NULL )
+  {
+    // grow in place if the blocks after the buffer are free
+    first = (old - string_arena) / STRING_ALLOC_UNIT;
+    run = (oldCapacity + 1) / STRING_ALLOC_UNIT;
+    for ( i = first + run; i < first + blocks && i < STRING_ARENA_BLOCKS && ! arenaIsUsed( i ); ++i );
+    if ( i == first + blocks )
+    {
+      arenaMark( first + run, blocks - run, 1 );
+      capacity = blocks * STRING_ALLOC_UNIT - 1;
+      return( old );
+    }
+  }
+
+  // first fit
+  run = 0;
+  for ( i = 0; i < STRING_ARENA_BLOCKS; ++i )
+  {
+    if ( arenaIsUsed( i ) )
+    {
+      run = 0;
+    }
+    else if ( ++run == blocks )
+    {
+      first = i + 1 - blocks;
+      arenaMark( first, blocks, 1 );
+      capacity = blocks * STRING_ALLOC_UNIT - 1;
+      if ( old != NULL )
+      {
+        memcpy( &string_arena[first * STRING_ALLOC_UNIT], old, oldCapacity + 1 );
+        arenaMark( (old - string_arena) / STRING_ALLOC_UNIT, (oldCapacity + 1) / STRING_ALLOC_UNIT, 0 );
+      }
+      return( &string_arena[first * STRING_ALLOC_UNIT] );
+    }
+  }
+  return( NULL );
+}
+
+static void stringFree( char *buffer, unsigned int capacity )
+{
+  arenaMark( (buffer - string_arena) / STRING_ALLOC_UNIT, (capacity + 1) / STRING_ALLOC_UNIT, 0 );
+}
+
+#else
+
+static char *stringAlloc( char *old, unsigned int oldCapacity, unsigned int &capacity )
+{
+  unsigned int size = (capacity + STRING_ALLOC_UNIT) & ~(STRING_ALLOC_UNIT - 1);
+  char *temp = (char *) realloc( old, size );
+
+  if ( temp != NULL )
+    capacity = size - 1;
+  return( temp );
+}
+
+static void stringFree( char *buffer, unsigned int capacity )
+{
+  free( buffer );
+}
+
+#endif
+
+// Makes room for maxStrLen characters keeping what is there.  On failure
+// the String is unchanged and 0 is returned.
+unsigned char String::getBuffer( unsigned int maxStrLen )
+{
+  char *temp;
+
+  if ( maxStrLen <= _capacity )
+    return 1;
+
+  if ( _buffer == _inline )
+  {
+    temp = stringAlloc( NULL, 0, maxStrLen );
+    if ( temp == NULL )
+      return 0;
+    memcpy( temp, _inline, _length + 1 );
+  }
+  else
+  {
+    temp = stringAlloc( _buffer, _capacity, maxStrLen );
+    if ( temp == NULL )
+      return 0;
+  }
+
+  _buffer = temp;
+  _capacity = maxStrLen;
+  return 1;
+}
+
+// Replaces the contents.  If there is no room the String ends up empty.
+void String::copy( const char *value, unsigned int length )
+{
+  if ( ! getBuffer( length ) )
+    length = 0;
+  memcpy( _buffer, value, length );
+  _buffer[ length ] = 0;
+  _length = length;
+}
+
+// Replaces the contents with a string from flash.
+void String::copy( fstr_t *value )
+{
+  unsigned int length = strlen_P( (PGM_P) value );
+
+  if ( ! getBuffer( length ) )
+    length = 0;
+  memcpy_P( _buffer, value, length );
+  _buffer[ length ] = 0;
+  _length = length;
+}
+
+String::String( fstr_t *value )
+{
+  init();
+  copy( value );
+}
+
 String::String( const char *value )
 {
-  if ( value == NULL )
-    value = "";
-  getBuffer( _length = strlen( value ) );
-  if ( _buffer != NULL )
-    strcpy( _buffer, value );
+  init();
+  if ( value != NULL )
+    copy( value, strlen( value ) );
 }
 
 String::String( const String &value )
 {
-  getBuffer( _length = value._length );
-  if ( _buffer != NULL )
-    strcpy( _buffer, value._buffer );
+  init();
+  copy( value._buffer, value._length );
 }
 
 String::String( const char value )
 {
+  init();
   _length = 1;
-  getBuffer(1);
-  if ( _buffer != NULL ) {
-    _buffer[0] = value;
-    _buffer[1] = 0;
-  }
+  _buffer[0] = value;
+  _buffer[1] = 0;
 }
 
 String::String( const unsigned char value )
 {
+  init();
   _length = 1;
-  getBuffer(1);
-  if ( _buffer != NULL) {
-    _buffer[0] = value;
-    _buffer[1] = 0;
-  }
+  _buffer[0] = value;
+  _buffer[1] = 0;
 }
 
 String::String( const int value, const int base )
 {
   char buf[33];   
   itoa((signed long)value, buf, base);
-  getBuffer( _length = strlen(buf) );
-  if ( _buffer != NULL )
-    strcpy( _buffer, buf );
+  init();
+  copy( buf, strlen(buf) );
 }
 
 String::String( const unsigned int value, const int base )
 {
   char buf[33];   
   ultoa((unsigned long)value, buf, base);
-  getBuffer( _length = strlen(buf) );
-  if ( _buffer != NULL )
-    strcpy( _buffer, buf );
+  init();
+  copy( buf, strlen(buf) );
 }
 
 String::String( const long value, const int base )
 {
   char buf[33];   
   ltoa(value, buf, base);
-  getBuffer( _length = strlen(buf) );
-  if ( _buffer != NULL )
-    strcpy( _buffer, buf );
+  init();
+  copy( buf, strlen(buf) );
 }
 
 String::String( const unsigned long value, const int base )
 {
   char buf[33];   
-  ultoa(value, buf, 10);
-  getBuffer( _length = strlen(buf) );
-  if ( _buffer != NULL )
-    strcpy( _buffer, buf );
+  ultoa(value, buf, base);
+  init();
+  copy( buf, strlen(buf) );
+}
+
+String::~String()
+{
+  if ( _buffer != _inline )
+    stringFree( _buffer, _capacity );
 }
 
+#if __cplusplus >= 201103L
+
+String::String( String &&rhs )
+{
+  init();
+  swap( rhs );
+}
+
+String & String::operator=( String &&rhs )
+{
+  if ( this != &rhs )
+  {
+    // An inline rhs is a plain copy; keep our own buffer in that case.
+    if ( rhs._buffer == rhs._inline )
+      copy( rhs._buffer, rhs._length );
+    else
+      swap( rhs );
+  }
+  return *this;
+}
+
+#endif
+
 char String::charAt( unsigned int loc ) const
 {
   return operator[]( loc );
@@ -112,54 +291,118 @@ int String::compareTo( const String &s2 ) const
   return strcmp( _buffer, s2._buffer );
 }
 
+int String::compareTo( fstr_t *s2 ) const
+{
+  return strcmp_P( _buffer, (PGM_P) s2 );
+}
+
 const String & String::concat( const String &s2 )
 {
   return (*this) += s2;
 }
 
-const String & String::operator=( const String &rhs )
+// Appends in place.  On failure the String is unchanged and 0 is returned.
+unsigned char String::concat( const char *str, unsigned int length )
 {
-  if ( this == &rhs )
-    return *this;
+  unsigned int offset;
 
-  if ( rhs._length > _length )
+  if ( length == 0 )
+    return 1;
+
+  if ( str >= _buffer && str <= _buffer + _length )
   {
-    free(_buffer);
-    getBuffer( rhs._length );
+    // appending (part of) ourselves; the buffer may move
+    offset = str - _buffer;
+    if ( ! getBuffer( _length + length ) )
+      return 0;
+    str = _buffer + offset;
   }
-  
-  if ( _buffer != NULL ) {
-    _length = rhs._length;
-    strcpy( _buffer, rhs._buffer );
+  else if ( ! getBuffer( _length + length ) )
+  {
+    return 0;
   }
+
+  memcpy( _buffer + _length, str, length );
+  _length += length;
+  _buffer[ _length ] = 0;
+  return 1;
+}
+
+unsigned char String::reserve( unsigned int size )
+{
+  return getBuffer( size );
+}
+
+// Exchanges the contents without copying anything that was allocated.
+void String::swap( String &rhs )
+{
+  char temp[ STRING_INLINE_SIZE ];
+  char *buffer = _buffer;
+  unsigned int capacity = _capacity;
+  unsigned int length = _length;
+
+  memcpy( temp, _inline, STRING_INLINE_SIZE );
+  memcpy( _inline, rhs._inline, STRING_INLINE_SIZE );
+  memcpy( rhs._inline, temp, STRING_INLINE_SIZE );
+
+  _buffer = ( rhs._buffer == rhs._inline ) ? _inline : rhs._buffer;
+  _capacity = rhs._capacity;
+  _length = rhs._length;
+
+  rhs._buffer = ( buffer == _inline ) ? rhs._inline : buffer;
+  rhs._capacity = capacity;
+  rhs._length = length;
+}
+
+const String & String::operator=( const String &rhs )
+{
+  if ( this != &rhs )
+    copy( rhs._buffer, rhs._length );
   return *this;
 }
 
-//const String & String::operator+=( const char aChar )
-//{
-//  if ( _length == _capacity )
-//    doubleBuffer();
-//
-//  _buffer[ _length++ ] = aChar;
-//  _buffer[ _length ] = '\0';
-//  return *this;
-//}
+const String & String::operator=( const char *rhs )
+{
+  if ( rhs == NULL )
+    rhs = "";
+  copy( rhs, strlen( rhs ) );
+  return *this;
+}
 
-const String & String::operator+=( const String &other )
+const String & String::operator=( fstr_t *rhs )
+{
+  copy( rhs );
+  return *this;
+}
+
+const String & String::operator+=( fstr_t *other )
 {
-  _length += other._length;
-  if ( _length > _capacity )
+  unsigned int length = strlen_P( (PGM_P) other );
+
+  if ( getBuffer( _length + length ) )
   {
-    char *temp = (char *)realloc(_buffer, _length + 1);
-    if ( temp != NULL ) {
-      _buffer = temp;
-      _capacity = _length;
-    } else {
-      _length -= other._length;
-      return *this;
-    }
+    memcpy_P( _buffer + _length, other, length + 1 );
+    _length += length;
   }
-  strcat( _buffer, other._buffer );
+  return *this;
+}
+
+const String & String::operator+=( const char aChar )
+{
+  concat( &aChar, 1 );
+  return *this;
+}
+
+const String & String::operator+=( const char *other )
+{
+  if ( other != NULL )
+    concat( other, strlen( other ) );
+  return *this;
+}
+
+const String & String::operator+=( const String &other )
+{
+  concat( other._buffer, other._length );
   return *this;
 }
 
@@ -174,6 +417,16 @@ int String::operator!=( const String &rhs ) const
   return ( _length != rhs.length() || strcmp( _buffer, rhs._buffer ) != 0 );
 }
 
+int String::operator==( fstr_t *rhs ) const
+{
+  return equals( rhs );
+}
+
+int String::operator!=( fstr_t *rhs ) const
+{
+  return ! equals( rhs );
+}
+
 int String::operator<( const String &rhs ) const
 {
   return strcmp( _buffer, rhs._buffer ) < 0;
@@ -223,6 +476,21 @@ boolean String::equals( const String &s2 ) const
   return ( _length == s2._length && strcmp( _buffer,s2._buffer ) == 0 );
 }
 
+boolean String::equals( fstr_t *s2 ) const
+{
+  return strcmp_P( _buffer, (PGM_P) s2 ) == 0;
+}
+
+boolean String::endsWith( fstr_t *s2 ) const
+{
+  unsigned int length = strlen_P( (PGM_P) s2 );
+
+  if ( _length < length )
+    return 0;
+
+  return strcmp_P( &_buffer[ _length - length ], (PGM_P) s2 ) == 0;
+}
+
 boolean String::equalsIgnoreCase( const String &s2 ) const
 {
   if ( this == &s2 )
@@ -295,6 +563,24 @@ int String::indexOf( const String &s2, unsigned int fromIndex ) const
   return theFind - _buffer; // pointer subtraction
 }
 
+int String::indexOf( fstr_t *s2 ) const
+{
+  return indexOf( s2, 0 );
+}
+
+int String::indexOf( fstr_t *s2, unsigned int fromIndex ) const
+{
+  if ( fromIndex >= _length )
+    return -1;
+
+  const char *theFind = strstr_P( &_buffer[ fromIndex ], (PGM_P) s2 );
+
+  if ( theFind == NULL )
+    return -1;
+
+  return theFind - _buffer;
+}
+
 int String::lastIndexOf( char theChar ) const
 {
   return lastIndexOf( theChar, _length - 1 );
@@ -354,6 +640,11 @@ boolean String::startsWith( const String &s2, unsigned int offset ) const
   return strncmp( &_buffer[offset], s2._buffer, s2._length ) == 0;
 }
 
+boolean String::startsWith( fstr_t *s2 ) const
+{
+  return strncmp_P( _buffer, (PGM_P) s2, strlen_P( (PGM_P) s2 ) ) == 0;
+}
+
 String String::substring( unsigned int left ) const
 {
   return substring( left, _length );
@@ -373,16 +664,15 @@ String String::substring( unsigned int left, unsigned int right ) const
     right = _length;
   } 
 
-  char temp = _buffer[ right ];  // save the replaced character
-  _buffer[ right ] = '\0';	
-  String outPut = ( _buffer + left );  // pointer arithmetic
-  _buffer[ right ] = temp;  //restore character
+  String outPut;
+  if ( left < right )
+    outPut.copy( _buffer + left, right - left );
   return outPut;
 }
 
 String String::toLowerCase() const
 {
-  String temp = _buffer;
+  String temp = *this;
 
   for ( unsigned int i = 0; i < _length; i++ )
     temp._buffer[ i ] = (char)tolower( temp._buffer[ i ] );
@@ -391,7 +681,7 @@ String String::toLowerCase() const
 
 String String::toUpperCase() const
 {
-  String temp = _buffer;
+  String temp = *this;
 
   for ( unsigned int i = 0; i < _length; i++ )
     temp._buffer[ i ] = (char)toupper( temp._buffer[ i ] );
@@ -24,6 +24,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <avr/pgmspace.h>
+
+#include "core_build_options.h"
+
+/*
+  A string in flash.  F("text") puts the text in flash and gives a pointer
+  to it; Print, String and the String comparisons and searches take that
+  pointer directly so the text is never copied to SRAM.
+*/
+typedef struct
+{
+  char c;
+}
+fstr_t;
+
+/* rmv: Use the macro below in preparation for the next Arduino release.
+# define FSTR(s) ((fstr_t*)PSTR(s))
+*/
+# define F(s) ((fstr_t*)PSTR(s))
 
 class String
 {
@@ -37,14 +56,25 @@ class String
     String( const unsigned int, const int base=10 );
     String( const long, const int base=10 );
     String( const unsigned long, const int base=10 );
-    ~String() { free(_buffer); _length = _capacity = 0;}     //added _length = _capacity = 0;
+    String( fstr_t *value );
+    ~String();
+#if __cplusplus >= 201103L
+    String( String &&rhs );
+    String & operator = ( String &&rhs );
+#endif
 
     // operators
     const String & operator = ( const String &rhs );
+    const String & operator = ( const char *rhs );
+    const String & operator = ( fstr_t *rhs );
     const String & operator +=( const String &rhs );
-    //const String & operator +=( const char );
+    const String & operator +=( const char *rhs );
+    const String & operator +=( const char );
+    const String & operator +=( fstr_t *rhs );
     int operator ==( const String &rhs ) const;
     int	operator !=( const String &rhs ) const;
+    int operator ==( fstr_t *rhs ) const;
+    int	operator !=( fstr_t *rhs ) const;
     int	operator < ( const String &rhs ) const;
     int	operator > ( const String &rhs ) const;
     int	operator <=( const String &rhs ) const;
@@ -56,21 +86,28 @@ class String
     // general methods
     char charAt( unsigned int index ) const;
     int	compareTo( const String &anotherString ) const;
+    int	compareTo( fstr_t *anotherString ) const;
     unsigned char endsWith( const String &suffix ) const;
+    unsigned char endsWith( fstr_t *suffix ) const;
     unsigned char equals( const String &anObject ) const;
+    unsigned char equals( fstr_t *anObject ) const;
     unsigned char equalsIgnoreCase( const String &anotherString ) const;
     int	indexOf( char ch ) const;
     int	indexOf( char ch, unsigned int fromIndex ) const;
     int	indexOf( const String &str ) const;
     int	indexOf( const String &str, unsigned int fromIndex ) const;
+    int	indexOf( fstr_t *str ) const;
+    int	indexOf( fstr_t *str, unsigned int fromIndex ) const;
     int	lastIndexOf( char ch ) const;
     int	lastIndexOf( char ch, unsigned int fromIndex ) const;
     int	lastIndexOf( const String &str ) const;
     int	lastIndexOf( const String &str, unsigned int fromIndex ) const;
     const unsigned int length( ) const { return _length; }
+    const char *c_str( ) const { return _buffer; }
     void setCharAt(unsigned int index, const char ch);
     unsigned char startsWith( const String &prefix ) const;
     unsigned char startsWith( const String &prefix, unsigned int toffset ) const;
+    unsigned char startsWith( fstr_t *prefix ) const;
     String substring( unsigned int beginIndex ) const;
     String substring( unsigned int beginIndex, unsigned int endIndex ) const;
     String toLowerCase( ) const;
@@ -80,32 +117,41 @@ class String
     void toCharArray(char *buf, unsigned int bufsize);
     long toInt( );
     const String& concat( const String &str );
+    unsigned char concat( const char *str, unsigned int length );
+    unsigned char reserve( unsigned int size );
+    void swap( String &rhs );
     String replace( char oldChar, char newChar );
     String replace( const String& match, const String& replace );
     friend String operator + ( String lhs, const String &rhs );
 
   protected:
-    char *_buffer;	     // the actual char array
+    char *_buffer;	     // the actual char array (_inline or allocated)
     unsigned int _capacity;  // the array length minus one (for the '\0')
     unsigned int _length;    // the String length (not counting the '\0')
+    char _inline[STRING_INLINE_SIZE];  // short strings live here
 
-    void getBuffer(unsigned int maxStrLen);
+    void init( void );
+    unsigned char getBuffer( unsigned int maxStrLen );
+    void copy( const char *value, unsigned int length );
+    void copy( fstr_t *value );
 
   private:
 
 };
 
-// allocate buffer space
-inline void String::getBuffer(unsigned int maxStrLen)
+// empty, using the buffer inside the object
+inline void String::init( void )
 {
-  _capacity = maxStrLen;
-  _buffer = (char *) malloc(_capacity + 1);
-  if (_buffer == NULL) _length = _capacity = 0;
+  _buffer = _inline;
+  _capacity = STRING_INLINE_SIZE - 1;
+  _length = 0;
+  _inline[0] = 0;
 }
 
 inline String operator+( String lhs, const String &rhs )
 {
-  return lhs += rhs;
+  lhs += rhs;
+  return lhs;
 }
 
 
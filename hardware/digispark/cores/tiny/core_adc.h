@@ -87,6 +87,20 @@ __attribute__((always_inline)) static inline void ADC_Enable( void )
   ADCSRA |= MASK1( ADEN );
 }
 
+/*
+  Note: ADIF is cleared by writing a one so both of these also clear a 
+  pending conversion-complete flag.
+*/
+__attribute__((always_inline)) static inline void ADC_EnableInterrupt( void )
+{
+  ADCSRA |= MASK1( ADIE );
+}
+
+__attribute__((always_inline)) static inline void ADC_DisableInterrupt( void )
+{
+  ADCSRA &= ~MASK1( ADIE );
+}
+
 #endif
 
 
@@ -39,6 +39,48 @@
 #define INITIALIZE_ANALOG_TO_DIGITAL_CONVERTER    1
 #define INITIALIZE_SECONDARY_TIMERS               1
 
+/*
+  delay() puts the processor in idle sleep between millis timer interrupts 
+  (see idle() in wiring.c).  Every interrupt still wakes it.  Set to 0 to 
+  spin like the original delay().
+*/
+#define DELAY_USES_IDLE_SLEEP                     1
+
+/*
+  A String keeps up to STRING_INLINE_SIZE - 1 characters inside the object.
+  Longer ones are allocated from a static arena of STRING_ARENA_SIZE bytes
+  (so Strings can't fragment the heap or grow into the stack) or, when 
+  STRING_ARENA_SIZE is 0, from malloc.  The arena only takes RAM in sketches
+  that use String.
+*/
+#define STRING_INLINE_SIZE                        8
+#define STRING_ARENA_SIZE                         0
+
+/*
+  Serial.beginBuffered (TinyDebugSerial) queues up to 
+  TINY_DEBUG_SERIAL_BUFFER_SIZE bytes and sends them from the user timer's
+  compare interrupt.  Must be a power of two no bigger than 128.
+*/
+#define TINY_DEBUG_SERIAL_BUFFER_SIZE             16
+
+/*
+  malloc, free, realloc (and so new, delete and String) can come from a
+  fixed-block pool instead of avr-libc's heap: POOL_BLOCKS_n blocks of 
+  POOL_SIZE_n bytes for each of four size classes, smallest first.  A 
+  request takes a block from the smallest class it fits, or the next one
+  up when that class is empty.  Nothing fragments and nothing grows into
+  the stack.  With every POOL_BLOCKS_n at 0 (the default) avr-libc's 
+  malloc is used.
+*/
+#define POOL_SIZE_1                               8
+#define POOL_BLOCKS_1                             0
+#define POOL_SIZE_2                               16
+#define POOL_BLOCKS_2                             0
+#define POOL_SIZE_3                               32
+#define POOL_BLOCKS_3                             0
+#define POOL_SIZE_4                               128
+#define POOL_BLOCKS_4                             0
+
 
 /*=============================================================================
   Build options for the ATtinyX313 processor
@@ -66,6 +108,8 @@
 
 #define HAVE_ADC                                  0
 
+#define HAVE_PIN_TOGGLE                           1
+
 #define DEFAULT_TO_TINY_DEBUG_SERIAL              0
 
 #endif
@@ -97,6 +141,8 @@
 
 #define HAVE_ADC                                  1
 
+#define HAVE_PIN_TOGGLE                           1
+
 #define DEFAULT_TO_TINY_DEBUG_SERIAL              1
 
 #endif
@@ -136,6 +182,8 @@
 
 #define HAVE_ADC                                  1
 
+#define HAVE_PIN_TOGGLE                           1
+
 #define DEFAULT_TO_TINY_DEBUG_SERIAL              1
 
 #endif
@@ -169,6 +217,88 @@
 #endif
 
 
+/*=============================================================================
+  Writing a one to PINxn toggles PORTxn on all the processors above.  The
+  multi-pin functions in core_digital.h fall back to a read-modify-write with
+  interrupts disabled on anything that can't.
+=============================================================================*/
+
+#if ! defined( HAVE_PIN_TOGGLE )
+  #define HAVE_PIN_TOGGLE   0
+#endif
+
+
+/*=============================================================================
+  Allow delay() to sleep
+=============================================================================*/
+
+#if ! defined( DELAY_USES_IDLE_SLEEP )
+  #define DELAY_USES_IDLE_SLEEP   0
+#endif
+
+
+/*=============================================================================
+  String memory
+=============================================================================*/
+
+#if ! defined( STRING_INLINE_SIZE ) || (STRING_INLINE_SIZE < 2)
+  #undef STRING_INLINE_SIZE
+  #define STRING_INLINE_SIZE   8
+#endif
+
+#if ! defined( STRING_ARENA_SIZE )
+  #define STRING_ARENA_SIZE   0
+#endif
+
+
+/*=============================================================================
+  Buffered TinyDebugSerial
+=============================================================================*/
+
+#if ! defined( TINY_DEBUG_SERIAL_BUFFER_SIZE )
+  #define TINY_DEBUG_SERIAL_BUFFER_SIZE   16
+#endif
+
+#if ((TINY_DEBUG_SERIAL_BUFFER_SIZE & (TINY_DEBUG_SERIAL_BUFFER_SIZE - 1)) != 0) || (TINY_DEBUG_SERIAL_BUFFER_SIZE > 128)
+  #error TINY_DEBUG_SERIAL_BUFFER_SIZE has to be a power of two no bigger than 128.
+#endif
+
+
+/*=============================================================================
+  Pool allocator
+=============================================================================*/
+
+#if ! defined( POOL_BLOCKS_1 )
+  #define POOL_SIZE_1     8
+  #define POOL_BLOCKS_1   0
+#endif
+
+#if ! defined( POOL_BLOCKS_2 )
+  #define POOL_SIZE_2     16
+  #define POOL_BLOCKS_2   0
+#endif
+
+#if ! defined( POOL_BLOCKS_3 )
+  #define POOL_SIZE_3     32
+  #define POOL_BLOCKS_3   0
+#endif
+
+#if ! defined( POOL_BLOCKS_4 )
+  #define POOL_SIZE_4     128
+  #define POOL_BLOCKS_4   0
+#endif
+
+#define POOL_ENABLED      ((POOL_BLOCKS_1 + POOL_BLOCKS_2 + POOL_BLOCKS_3 + POOL_BLOCKS_4) > 0)
+
+#if (POOL_SIZE_1 < 2) || (POOL_SIZE_2 < POOL_SIZE_1) || (POOL_SIZE_3 < POOL_SIZE_2) || (POOL_SIZE_4 < POOL_SIZE_3)
+  #error The pool sizes have to go up and be at least two bytes.
+#endif
+
+#if (POOL_BLOCKS_1 > 255) || (POOL_BLOCKS_2 > 255) || (POOL_BLOCKS_3 > 255) || (POOL_BLOCKS_4 > 255)
+  #error A pool size class can have at most 255 blocks.
+#endif
+
+
 /*=============================================================================
   Allow the "secondary timers" to be optional for low-power applications
 =============================================================================*/
@@ -0,0 +1,293 @@
+/*==============================================================================
+
+  core_digital.h - Compile-time fast path for pinMode, digitalWrite, and
+      digitalRead plus multi-pin access to a whole port.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#ifndef core_digital_h
+#define core_digital_h
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "core_build_options.h"
+#include "core_pins.h"
+#include "core_timers.h"
+#include "pins_arduino.h"
+#include "PwmTimer.h"
+
+
+/*=============================================================================
+  If the pin supports PWM output it has to be disconnected from the timer
+  before a digital read or write.  When the pin is a constant all but one
+  (or none) of the branches below are removed by the compiler.
+=============================================================================*/
+
+__attribute__((always_inline)) static inline void turnOffPWM( uint8_t pin )
+{
+  #if CORE_PWM_COUNT >= 1
+    if ( pin == CORE_PWM0_PIN )
+    {
+      Pwm0_SetCompareOutputMode( Pwm0_Disconnected );
+    }
+    else
+  #endif
+
+  #if CORE_PWM_COUNT >= 2
+    if ( pin == CORE_PWM1_PIN )
+    {
+      Pwm1_SetCompareOutputMode( Pwm1_Disconnected );
+    }
+    else
+  #endif
+
+  #if CORE_PWM_COUNT >= 3
+    if ( pin == CORE_PWM2_PIN )
+    {
+      Pwm2_SetCompareOutputMode( Pwm2_Disconnected );
+    }
+    else
+  #endif
+
+  #if CORE_PWM_COUNT >= 4
+    if ( pin == CORE_PWM3_PIN )
+    {
+      Pwm3_SetCompareOutputMode( Pwm3_Disconnected );
+    }
+    else
+  #endif
+
+  #if CORE_PWM_COUNT >= 5
+  #error Only 4 PWM pins are supported.  Add more conditions.
+  #endif
+
+    {
+    }
+}
+
+
+/*=============================================================================
+  When the pin number is a compile-time constant the port, mask, and PWM
+  checks are resolved by the compiler and each call becomes a single sbi,
+  cbi, or sbis (plus a disconnect of the timer output for the PWM pins).
+  sbi / cbi are atomic so there is no need to save SREG and disable
+  interrupts.  A pin number that is not a constant (or not a valid pin) goes
+  through the out-of-line functions in wiring_digital.c exactly as before.
+=============================================================================*/
+
+#define digitalPinIsConstant(pin)   ( __builtin_constant_p( pin ) && CORE_PIN_IS_VALID( pin ) )
+
+__attribute__((always_inline)) static inline void pinModeInline( uint8_t pin, uint8_t mode )
+{
+  if ( digitalPinIsConstant( pin ) )
+  {
+    if ( mode == INPUT )
+      *CORE_PIN_TO_DDR( pin ) &= ~_BV( CORE_PIN_TO_BIT( pin ) );
+    else
+      *CORE_PIN_TO_DDR( pin ) |= _BV( CORE_PIN_TO_BIT( pin ) );
+  }
+  else
+  {
+    pinMode( pin, mode );
+  }
+}
+
+__attribute__((always_inline)) static inline void digitalWriteInline( uint8_t pin, uint8_t val )
+{
+  if ( digitalPinIsConstant( pin ) )
+  {
+    turnOffPWM( pin );
+
+    if ( val == LOW )
+      *CORE_PIN_TO_PORT( pin ) &= ~_BV( CORE_PIN_TO_BIT( pin ) );
+    else
+      *CORE_PIN_TO_PORT( pin ) |= _BV( CORE_PIN_TO_BIT( pin ) );
+  }
+  else
+  {
+    digitalWrite( pin, val );
+  }
+}
+
+__attribute__((always_inline)) static inline int digitalReadInline( uint8_t pin )
+{
+  if ( digitalPinIsConstant( pin ) )
+  {
+    turnOffPWM( pin );
+
+    if ( *CORE_PIN_TO_PIN( pin ) & _BV( CORE_PIN_TO_BIT( pin ) ) )
+      return( HIGH );
+    return( LOW );
+  }
+  else
+  {
+    return( digitalRead( pin ) );
+  }
+}
+
+/*
+  wiring_digital.c defines CORE_DIGITAL_OUT_OF_LINE so it can provide the
+  real functions.  Taking the address of pinMode, digitalWrite, or
+  digitalRead still gives the out-of-line function.
+*/
+#if ! defined( CORE_DIGITAL_OUT_OF_LINE )
+  #define pinMode(pin,mode)         pinModeInline( (pin), (mode) )
+  #define digitalWrite(pin,val)     digitalWriteInline( (pin), (val) )
+  #define digitalRead(pin)          digitalReadInline( (pin) )
+#endif
+
+
+/*=============================================================================
+  Multi-pin access.  The port is one of the PORT_x_ID values from
+  pins_arduino.h (what digitalPinToPort returns) and the mask selects the
+  pins.  Only the pins in the mask are changed.  The other pins on the port
+  can be changed at the same time by an interrupt service routine (V-USB,
+  for example) without either side losing an update.
+
+  With HAVE_PIN_TOGGLE the output functions work out which of the masked
+  bits have to change and write them to PINx.  That is a single write with
+  no need to disable interrupts and all the pins change on the same cycle.
+  A single-bit constant mask on a constant port is a plain sbi / cbi.
+
+  The ...Reg versions take the PORTx register instead of the port number
+  for code that caches portOutputRegister().
+=============================================================================*/
+
+#if defined( __AVR_ATtinyX313__ )
+  #define corePortToOutput(port)      ( (port) == PORT_A_ID ? &PORTA : (port) == PORT_B_ID ? &PORTB : &PORTD )
+#elif defined( __AVR_ATtinyX4__ )
+  #define corePortToOutput(port)      ( (port) == PORT_A_ID ? &PORTA : &PORTB )
+#elif defined( __AVR_ATtinyX5__ )
+  #define corePortToOutput(port)      ( &PORTB )
+#endif
+
+// PINx, DDRx, and PORTx are consecutive on all the supported processors
+#define corePortOutputToInput(out)    ( (out) - 2 )
+#define corePortOutputToMode(out)     ( (out) - 1 )
+
+#define corePortIsSingleBit(out,mask) ( __builtin_constant_p( out ) && __builtin_constant_p( mask ) && ((mask) != 0) && (((mask) & ((mask) - 1)) == 0) )
+
+__attribute__((always_inline)) static inline volatile uint8_t * portToOutputRegister( uint8_t port )
+{
+  if ( __builtin_constant_p( port ) )
+    return( corePortToOutput( port ) );
+  return( portOutputRegister( port ) );
+}
+
+__attribute__((always_inline)) static inline uint8_t portReadReg( volatile uint8_t *out, uint8_t mask )
+{
+  return( *corePortOutputToInput( out ) & mask );
+}
+
+__attribute__((always_inline)) static inline void portWriteReg( volatile uint8_t *out, uint8_t mask, uint8_t value )
+{
+  #if HAVE_PIN_TOGGLE
+    *corePortOutputToInput( out ) = (*out ^ value) & mask;
+  #else
+    uint8_t oldSREG = SREG;
+    cli();
+    *out = (*out & ~mask) | (value & mask);
+    SREG = oldSREG;
+  #endif
+}
+
+__attribute__((always_inline)) static inline void portSetReg( volatile uint8_t *out, uint8_t mask )
+{
+  if ( corePortIsSingleBit( out, mask ) )
+  {
+    *out |= mask;
+  }
+  else
+  {
+    #if HAVE_PIN_TOGGLE
+      *corePortOutputToInput( out ) = ~*out & mask;
+    #else
+      uint8_t oldSREG = SREG;
+      cli();
+      *out |= mask;
+      SREG = oldSREG;
+    #endif
+  }
+}
+
+__attribute__((always_inline)) static inline void portClearReg( volatile uint8_t *out, uint8_t mask )
+{
+  if ( corePortIsSingleBit( out, mask ) )
+  {
+    *out &= ~mask;
+  }
+  else
+  {
+    #if HAVE_PIN_TOGGLE
+      *corePortOutputToInput( out ) = *out & mask;
+    #else
+      uint8_t oldSREG = SREG;
+      cli();
+      *out &= ~mask;
+      SREG = oldSREG;
+    #endif
+  }
+}
+
+__attribute__((always_inline)) static inline void portToggleReg( volatile uint8_t *out, uint8_t mask )
+{
+  #if HAVE_PIN_TOGGLE
+    *corePortOutputToInput( out ) = mask;
+  #else
+    uint8_t oldSREG = SREG;
+    cli();
+    *out ^= mask;
+    SREG = oldSREG;
+  #endif
+}
+
+__attribute__((always_inline)) static inline void portModeReg( volatile uint8_t *out, uint8_t mask, uint8_t mode )
+{
+  volatile uint8_t *ddr = corePortOutputToMode( out );
+
+  if ( corePortIsSingleBit( out, mask ) )
+  {
+    if ( mode == INPUT )
+      *ddr &= ~mask;
+    else
+      *ddr |= mask;
+  }
+  else
+  {
+    // There is no toggle register for the direction so this one has to be
+    // a read-modify-write.
+    uint8_t oldSREG = SREG;
+    cli();
+    if ( mode == INPUT )
+      *ddr &= ~mask;
+    else
+      *ddr |= mask;
+    SREG = oldSREG;
+  }
+}
+
+#define portRead(port,mask)           portReadReg( portToOutputRegister( port ), (mask) )
+#define portWrite(port,mask,value)    portWriteReg( portToOutputRegister( port ), (mask), (value) )
+#define portSet(port,mask)            portSetReg( portToOutputRegister( port ), (mask) )
+#define portClear(port,mask)          portClearReg( portToOutputRegister( port ), (mask) )
+#define portToggle(port,mask)         portToggleReg( portToOutputRegister( port ), (mask) )
+#define portMode(port,mask,mode)      portModeReg( portToOutputRegister( port ), (mask), (mode) )
+
+
+#endif
@@ -0,0 +1,94 @@
+/*==============================================================================
+
+  core_interrupts.h - Compile-time registration of handlers for the external
+      and pin change interrupts.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#ifndef core_interrupts_h
+#define core_interrupts_h
+
+#include <inttypes.h>
+#include <avr/io.h>
+
+#include "core_build_options.h"
+
+
+/*=============================================================================
+  WInterrupts.c owns INT0 and wiring_pin_change.c the pin change vector(s).
+  Anything that wants one of them defines a handler for a slot instead of
+  an ISR:
+
+    PCINT0_HANDLER( INTERRUPT_SLOT_PIN_CHANGE, _BV( PB3 ) )
+    {
+      // changed has the pins in the mask that changed; now is the port
+    }
+
+  The router calls the slots in order, lowest first, each one a direct call
+  to a weak symbol; an empty slot costs a compare and no handler runs
+  through a pointer.  The mask is folded into the handler by the compiler
+  and the handler is only called when one of its pins changed.  The macro
+  also pulls the router in from the core library.
+
+  Two handlers for the same slot fail to link, the same way two ISRs for
+  one vector did.  V-USB still needs the raw vector (its entry is cycle
+  counted) so it can't share PCINT0 with the router.
+=============================================================================*/
+
+#define INTERRUPT_SLOT_SERIAL         0
+#define INTERRUPT_SLOT_PIN_CHANGE     1
+#define INTERRUPT_SLOT_PULSE          2
+#define INTERRUPT_SLOT_ATTACH         3   // INT0 only; attachInterrupt
+
+#define INTERRUPT_SLOTS               4
+
+#if defined( __cplusplus )
+  #define INTERRUPT_EXTERN_C          extern "C"
+#else
+  #define INTERRUPT_EXTERN_C
+#endif
+
+#define INTERRUPT_STRING_(x)          #x
+#define INTERRUPT_STRING(x)           INTERRUPT_STRING_( x )
+
+#define INTERRUPT_PIN_CHANGE_HANDLER(vect,name,slot,mask)                                         \
+  __asm__( ".global " INTERRUPT_STRING( vect ) );                                                 \
+  __attribute__((always_inline)) static inline void name##Body_##slot( uint8_t changed, uint8_t now ); \
+  INTERRUPT_EXTERN_C void name##Handler_##slot( uint8_t changed, uint8_t now );                   \
+  void name##Handler_##slot( uint8_t changed, uint8_t now )                                       \
+  {                                                                                               \
+    if ( changed & (mask) )                                                                       \
+      name##Body_##slot( changed & (mask), now );                                                 \
+  }                                                                                               \
+  __attribute__((always_inline)) static inline void name##Body_##slot( uint8_t changed, uint8_t now )
+
+#define INT0_HANDLER(slot)                                                                        \
+  __asm__( ".global " INTERRUPT_STRING( INT0_vect ) );                                            \
+  INTERRUPT_EXTERN_C void int0Handler_##slot( void );                                             \
+  void int0Handler_##slot( void )
+
+#if defined( __AVR_ATtinyX5__ ) || defined( __AVR_ATtinyX4__ )
+  #define PCINT0_HANDLER(slot,mask)   INTERRUPT_PIN_CHANGE_HANDLER( PCINT0_vect, pcint0, slot, mask )
+#endif
+
+#if defined( __AVR_ATtinyX4__ )
+  #define PCINT1_HANDLER(slot,mask)   INTERRUPT_PIN_CHANGE_HANDLER( PCINT1_vect, pcint1, slot, mask )
+#endif
+
+
+#endif
@@ -62,6 +62,10 @@
 #define CORE_INT0_PIN  PIN_D2
 #define CORE_INT1_PIN  PIN_D3
 
+#define CORE_USI_DI_PIN   PIN_B5
+#define CORE_USI_DO_PIN   PIN_B6
+#define CORE_USI_SCK_PIN  PIN_B7
+
 #define CORE_OC0A_PIN  PIN_B2
 #define CORE_OC0B_PIN  PIN_D5
 #define CORE_OC1A_PIN  PIN_B3
@@ -85,6 +89,17 @@
 
 #define CORE_PWM_COUNT      (4)
 
+/*
+  Compile-time pin to register mapping.  These mirror the tables in 
+  pins_arduino.c and are used by core_digital.h when the pin number is a 
+  constant.
+*/
+#define CORE_PIN_IS_VALID(p)  ((p) <= 17)
+#define CORE_PIN_TO_PORT(p)   (((p) <= 1) || (((p) >= 4) && ((p) <= 8)) ? &PORTD : ((p) <= 3) || ((p) == 17) ? &PORTA : &PORTB)
+#define CORE_PIN_TO_DDR(p)    (((p) <= 1) || (((p) >= 4) && ((p) <= 8)) ? &DDRD  : ((p) <= 3) || ((p) == 17) ? &DDRA  : &DDRB)
+#define CORE_PIN_TO_PIN(p)    (((p) <= 1) || (((p) >= 4) && ((p) <= 8)) ? &PIND  : ((p) <= 3) || ((p) == 17) ? &PINA  : &PINB)
+#define CORE_PIN_TO_BIT(p)    (((p) <= 1) ? (p) : ((p) <= 3) ? (3-(p)) : ((p) <= 8) ? ((p)-2) : ((p) <= 16) ? ((p)-9) : 2)
+
 #endif
 
 
@@ -118,6 +133,10 @@
 
 #define CORE_INT0_PIN  PIN_B2
 
+#define CORE_USI_DI_PIN   PIN_A6
+#define CORE_USI_DO_PIN   PIN_A5
+#define CORE_USI_SCK_PIN  PIN_A4
+
 #define CORE_OC0A_PIN  PIN_B2
 #define CORE_OC0B_PIN  PIN_A7
 #define CORE_OC1A_PIN  PIN_A6
@@ -141,6 +160,18 @@
 
 #define CORE_PWM_COUNT      (4)
 
+/*
+  Compile-time pin to register mapping.  These mirror the tables in 
+  pins_arduino.c and are used by core_digital.h when the pin number is a 
+  constant.  The tables stop at pin 10, so pin 11 (PB3 / RESET) isn't 
+  valid here either.
+*/
+#define CORE_PIN_IS_VALID(p)  ((p) <= 10)
+#define CORE_PIN_TO_PORT(p)   (((p) <= 2) ? &PORTB : &PORTA)
+#define CORE_PIN_TO_DDR(p)    (((p) <= 2) ? &DDRB  : &DDRA)
+#define CORE_PIN_TO_PIN(p)    (((p) <= 2) ? &PINB  : &PINA)
+#define CORE_PIN_TO_BIT(p)    (((p) <= 2) ? (p) : (10-(p)))
+
 #endif
 
 
@@ -168,6 +199,10 @@
 
 #define CORE_INT0_PIN  PIN_B2
 
+#define CORE_USI_DI_PIN   PIN_B0
+#define CORE_USI_DO_PIN   PIN_B1
+#define CORE_USI_SCK_PIN  PIN_B2
+
 #define CORE_OC0A_PIN  PIN_B0
 #define CORE_OC0B_PIN  PIN_B1
 #define CORE_OC1A_PIN  PIN_B1
@@ -198,6 +233,17 @@ to use */
 
 #define CORE_PWM_COUNT      (3)
 
+/*
+  Compile-time pin to register mapping.  These mirror the tables in 
+  pins_arduino.c and are used by core_digital.h when the pin number is a 
+  constant.
+*/
+#define CORE_PIN_IS_VALID(p)  ((p) <= 5)
+#define CORE_PIN_TO_PORT(p)   (&PORTB)
+#define CORE_PIN_TO_DDR(p)    (&DDRB)
+#define CORE_PIN_TO_PIN(p)    (&PINB)
+#define CORE_PIN_TO_BIT(p)    (p)
+
 #endif
 
 
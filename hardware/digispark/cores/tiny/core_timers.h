@@ -189,6 +189,16 @@ __attribute__((always_inline)) static inline void Timer0_EnableOutputCompareInte
   TIMSK |= (1<<OCIE0A);
 } 
 
+__attribute__((always_inline)) static inline void Timer0_EnableOutputCompareInterruptB( void )
+{
+  TIMSK |= (1<<OCIE0B);
+}
+
+__attribute__((always_inline)) static inline void Timer0_DisableOutputCompareInterruptB( void )
+{
+  TIMSK &= ~(1<<OCIE0B);
+}
+
 __attribute__((always_inline)) static inline void Timer0_EnableOverflowInterrupt( void )
 {
   TIMSK |= (1<<TOIE0);
@@ -209,6 +219,12 @@ __attribute__((always_inline)) static inline uint8_t Timer0_IsOverflowSet( void
   return( (TIFR & (1<<TOV0)) != 0 );
 }
 
+__attribute__((always_inline)) static inline void Timer0_ClearOutputCompareMatchFlagA( void )
+{
+  // Writing a one clears the flag; the others are left alone
+  TIFR = (1<<OCF0A);
+}
+
 
 #define Timer1_OutputComparePinA  CORE_OC1A_PIN
 #define Timer1_OutputComparePinB  CORE_OC1B_PIN
@@ -349,6 +365,16 @@ __attribute__((always_inline)) static inline void Timer1_EnableOutputCompareInte
   TIMSK |= (1<<OCIE1A);
 } 
 
+__attribute__((always_inline)) static inline void Timer1_EnableOutputCompareInterruptB( void )
+{
+  TIMSK |= (1<<OCIE1B);
+}
+
+__attribute__((always_inline)) static inline void Timer1_DisableOutputCompareInterruptB( void )
+{
+  TIMSK &= ~(1<<OCIE1B);
+}
+
 __attribute__((always_inline)) static inline void Timer1_EnableOverflowInterrupt( void )
 {
   TIMSK |= (1<<TOIE1);
@@ -369,6 +395,12 @@ __attribute__((always_inline)) static inline uint8_t Timer1_IsOverflowSet( void
   return( (TIFR & (1<<TOV1)) != 0 );
 }
 
+__attribute__((always_inline)) static inline void Timer1_ClearOutputCompareMatchFlagA( void )
+{
+  // Writing a one clears the flag; the others are left alone
+  TIFR = (1<<OCF1A);
+}
+
 #endif
 
 
@@ -506,6 +538,16 @@ __attribute__((always_inline)) static inline void Timer0_EnableOutputCompareInte
   TIMSK0 |= (1<<OCIE0A);
 } 
 
+__attribute__((always_inline)) static inline void Timer0_EnableOutputCompareInterruptB( void )
+{
+  TIMSK0 |= (1<<OCIE0B);
+}
+
+__attribute__((always_inline)) static inline void Timer0_DisableOutputCompareInterruptB( void )
+{
+  TIMSK0 &= ~(1<<OCIE0B);
+}
+
 __attribute__((always_inline)) static inline void Timer0_EnableOverflowInterrupt( void )
 {
   TIMSK0 |= (1<<TOIE0);
@@ -526,6 +568,12 @@ __attribute__((always_inline)) static inline uint8_t Timer0_IsOverflowSet( void
   return( (TIFR0 & (1<<TOV0)) != 0 );
 }
 
+__attribute__((always_inline)) static inline void Timer0_ClearOutputCompareMatchFlagA( void )
+{
+  // Writing a one clears the flag; the others are left alone
+  TIFR0 = (1<<OCF0A);
+}
+
 
 #define Timer1_OutputComparePinA  CORE_OC1A_PIN
 #define Timer1_OutputComparePinB  CORE_OC1B_PIN
@@ -666,6 +714,16 @@ __attribute__((always_inline)) static inline void Timer1_EnableOutputCompareInte
   TIMSK1 |= (1<<OCIE1A);
 } 
 
+__attribute__((always_inline)) static inline void Timer1_EnableOutputCompareInterruptB( void )
+{
+  TIMSK1 |= (1<<OCIE1B);
+}
+
+__attribute__((always_inline)) static inline void Timer1_DisableOutputCompareInterruptB( void )
+{
+  TIMSK1 &= ~(1<<OCIE1B);
+}
+
 __attribute__((always_inline)) static inline void Timer1_EnableOverflowInterrupt( void )
 {
   TIMSK1 |= (1<<TOIE1);
@@ -686,6 +744,12 @@ __attribute__((always_inline)) static inline uint8_t Timer1_IsOverflowSet( void
   return( (TIFR1 & (1<<TOV1)) != 0 );
 }
 
+__attribute__((always_inline)) static inline void Timer1_ClearOutputCompareMatchFlagA( void )
+{
+  // Writing a one clears the flag; the others are left alone
+  TIFR1 = (1<<OCF1A);
+}
+
 #endif
 
 
@@ -823,6 +887,16 @@ __attribute__((always_inline)) static inline void Timer0_EnableOutputCompareInte
   TIMSK |= (1<<OCIE0A);
 } 
 
+__attribute__((always_inline)) static inline void Timer0_EnableOutputCompareInterruptB( void )
+{
+  TIMSK |= (1<<OCIE0B);
+}
+
+__attribute__((always_inline)) static inline void Timer0_DisableOutputCompareInterruptB( void )
+{
+  TIMSK &= ~(1<<OCIE0B);
+}
+
 __attribute__((always_inline)) static inline void Timer0_EnableOverflowInterrupt( void )
 {
   TIMSK |= (1<<TOIE0);
@@ -843,6 +917,12 @@ __attribute__((always_inline)) static inline uint8_t Timer0_IsOverflowSet( void
   return( (TIFR & (1<<TOV0)) != 0 );
 }
 
+__attribute__((always_inline)) static inline void Timer0_ClearOutputCompareMatchFlagA( void )
+{
+  // Writing a one clears the flag; the others are left alone
+  TIFR = (1<<OCF0A);
+}
+
 
 #define Timer1_OutputComparePinA  CORE_OC1A_PIN
 #define Timer1_OutputComparePinB  CORE_OC1B_PIN
@@ -1019,6 +1099,16 @@ __attribute__((always_inline)) static inline void Timer1_EnableOutputCompareInte
   TIMSK |= (1<<OCIE1A);
 } 
 
+__attribute__((always_inline)) static inline void Timer1_EnableOutputCompareInterruptB( void )
+{
+  TIMSK |= (1<<OCIE1B);
+}
+
+__attribute__((always_inline)) static inline void Timer1_DisableOutputCompareInterruptB( void )
+{
+  TIMSK &= ~(1<<OCIE1B);
+}
+
 __attribute__((always_inline)) static inline void Timer1_EnableOverflowInterrupt( void )
 {
   TIMSK |= (1<<TOIE1);
@@ -1039,6 +1129,12 @@ __attribute__((always_inline)) static inline uint8_t Timer1_IsOverflowSet( void
   return( (TIFR & (1<<TOV1)) != 0 );
 }
 
+__attribute__((always_inline)) static inline void Timer1_ClearOutputCompareMatchFlagA( void )
+{
+  // Writing a one clears the flag; the others are left alone
+  TIFR = (1<<OCF1A);
+}
+
 #endif
 
 
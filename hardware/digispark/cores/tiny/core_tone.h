@@ -0,0 +1,289 @@
+/*==============================================================================
+
+  core_tone.h - Prescaler selection for tone() and the compile-time fast path
+      for a constant frequency.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#ifndef core_tone_h
+#define core_tone_h
+
+#include <inttypes.h>
+
+#include "core_build_options.h"
+#include "ToneTimer.h"
+
+
+/*=============================================================================
+  TONE_FREQUENCY_CUTOFF_n is the highest frequency that can be generated
+  with prescaler n.  The largest prescaler that can reach the frequency gives
+  the best resolution.
+=============================================================================*/
+
+#if (TONETIMER_NUMBER_PRESCALERS != 5) && (TONETIMER_NUMBER_PRESCALERS != 15)
+#error Only five or fifteen prescalers are supported.  Update the code to support the number of actual prescalers.
+#endif
+
+#if TONETIMER_NUMBER_PRESCALERS == 15
+#define TONETIMER_MAXIMUM_DIVISOR  ( (unsigned long)(TONETIMER_(PRESCALER_VALUE_15)) * (1L + (unsigned long)(TONETIMER_(MAXIMUM_OCR))) )
+#endif
+
+#if TONETIMER_NUMBER_PRESCALERS == 5
+#define TONETIMER_MAXIMUM_DIVISOR  ( (unsigned long)(TONETIMER_(PRESCALER_VALUE_5)) * (1L + (unsigned long)(TONETIMER_(MAXIMUM_OCR))) )
+#endif
+
+#define TONE_LOWEST_FREQUENCY  ( (F_CPU + (2L * TONETIMER_MAXIMUM_DIVISOR - 1L)) / (2L * TONETIMER_MAXIMUM_DIVISOR) )
+
+#if (TONETIMER_(MAXIMUM_OCR) == 65535) && (TONETIMER_(PRESCALE_SET) == 1)
+#if F_CPU <= 1000000
+  #define TONE_FREQUENCY_CUTOFF_2  (7)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 8000000
+  #define TONE_FREQUENCY_CUTOFF_3  (7)
+  #define TONE_FREQUENCY_CUTOFF_2  (61)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 16000000
+  #define TONE_FREQUENCY_CUTOFF_4  (1)
+  #define TONE_FREQUENCY_CUTOFF_3  (15)
+  #define TONE_FREQUENCY_CUTOFF_2  (122)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 16500000
+  #define TONE_FREQUENCY_CUTOFF_4  (1)
+  #define TONE_FREQUENCY_CUTOFF_3  (15)
+  #define TONE_FREQUENCY_CUTOFF_2  (125)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#endif
+#endif
+
+#if (TONETIMER_(MAXIMUM_OCR) == 255) && (TONETIMER_(PRESCALE_SET) == 1)
+#if F_CPU <= 1000000
+  #define TONE_FREQUENCY_CUTOFF_5  (7)
+  #define TONE_FREQUENCY_CUTOFF_4  (30)
+  #define TONE_FREQUENCY_CUTOFF_3  (243)
+  #define TONE_FREQUENCY_CUTOFF_2  (1949)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 8000000
+  #define TONE_FREQUENCY_CUTOFF_5  (60)
+  #define TONE_FREQUENCY_CUTOFF_4  (243)
+  #define TONE_FREQUENCY_CUTOFF_3  (1949)
+  #define TONE_FREQUENCY_CUTOFF_2  (15594)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 16000000
+  #define TONE_FREQUENCY_CUTOFF_5  (121)
+  #define TONE_FREQUENCY_CUTOFF_4  (487)
+  #define TONE_FREQUENCY_CUTOFF_3  (3898)
+  #define TONE_FREQUENCY_CUTOFF_2  (31189)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 16500000
+  #define TONE_FREQUENCY_CUTOFF_5  (125)
+  #define TONE_FREQUENCY_CUTOFF_4  (502)
+  #define TONE_FREQUENCY_CUTOFF_3  (4020)
+  #define TONE_FREQUENCY_CUTOFF_2  (32163)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#endif
+#endif
+
+#if (TONETIMER_(MAXIMUM_OCR) == 255) && (TONETIMER_(PRESCALE_SET) == 2)
+#if F_CPU <= 1000000
+  #define TONE_FREQUENCY_CUTOFF_12 (1)
+  #define TONE_FREQUENCY_CUTOFF_11 (3)
+  #define TONE_FREQUENCY_CUTOFF_10 (7)
+  #define TONE_FREQUENCY_CUTOFF_9  (15)
+  #define TONE_FREQUENCY_CUTOFF_8  (30)
+  #define TONE_FREQUENCY_CUTOFF_7  (60)
+  #define TONE_FREQUENCY_CUTOFF_6  (121)
+  #define TONE_FREQUENCY_CUTOFF_5  (243)
+  #define TONE_FREQUENCY_CUTOFF_4  (487)
+  #define TONE_FREQUENCY_CUTOFF_3  (974)
+  #define TONE_FREQUENCY_CUTOFF_2  (1949)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 8000000
+  #define TONE_FREQUENCY_CUTOFF_15 (1)
+  #define TONE_FREQUENCY_CUTOFF_14 (3)
+  #define TONE_FREQUENCY_CUTOFF_13 (7)
+  #define TONE_FREQUENCY_CUTOFF_12 (15)
+  #define TONE_FREQUENCY_CUTOFF_11 (30)
+  #define TONE_FREQUENCY_CUTOFF_10 (60)
+  #define TONE_FREQUENCY_CUTOFF_9  (121)
+  #define TONE_FREQUENCY_CUTOFF_8  (243)
+  #define TONE_FREQUENCY_CUTOFF_7  (487)
+  #define TONE_FREQUENCY_CUTOFF_6  (974)
+  #define TONE_FREQUENCY_CUTOFF_5  (1949)
+  #define TONE_FREQUENCY_CUTOFF_4  (3898)
+  #define TONE_FREQUENCY_CUTOFF_3  (7797)
+  #define TONE_FREQUENCY_CUTOFF_2  (15594)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 16000000
+  #define TONE_FREQUENCY_CUTOFF_15 (3)
+  #define TONE_FREQUENCY_CUTOFF_14 (7)
+  #define TONE_FREQUENCY_CUTOFF_13 (15)
+  #define TONE_FREQUENCY_CUTOFF_12 (30)
+  #define TONE_FREQUENCY_CUTOFF_11 (60)
+  #define TONE_FREQUENCY_CUTOFF_10 (121)
+  #define TONE_FREQUENCY_CUTOFF_9  (243)
+  #define TONE_FREQUENCY_CUTOFF_8  (487)
+  #define TONE_FREQUENCY_CUTOFF_7  (974)
+  #define TONE_FREQUENCY_CUTOFF_6  (1949)
+  #define TONE_FREQUENCY_CUTOFF_5  (3898)
+  #define TONE_FREQUENCY_CUTOFF_4  (7797)
+  #define TONE_FREQUENCY_CUTOFF_3  (15594)
+  #define TONE_FREQUENCY_CUTOFF_2  (31189)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#elif F_CPU <= 16500000
+  #define TONE_FREQUENCY_CUTOFF_15 (3)
+  #define TONE_FREQUENCY_CUTOFF_14 (7)
+  #define TONE_FREQUENCY_CUTOFF_13 (15)
+  #define TONE_FREQUENCY_CUTOFF_12 (31)
+  #define TONE_FREQUENCY_CUTOFF_11 (62)
+  #define TONE_FREQUENCY_CUTOFF_10 (125)
+  #define TONE_FREQUENCY_CUTOFF_9  (251)
+  #define TONE_FREQUENCY_CUTOFF_8  (502)
+  #define TONE_FREQUENCY_CUTOFF_7  (1005)
+  #define TONE_FREQUENCY_CUTOFF_6  (2010)
+  #define TONE_FREQUENCY_CUTOFF_5  (4020)
+  #define TONE_FREQUENCY_CUTOFF_4  (8040)
+  #define TONE_FREQUENCY_CUTOFF_3  (16081)
+  #define TONE_FREQUENCY_CUTOFF_2  (32163)
+  #define TONE_FREQUENCY_CUTOFF_1  (65535)
+#endif
+#endif
+
+
+/*
+  A prescaler that is never the best choice gets a cutoff of zero so the
+  tables and the macros below can treat every index the same way.
+*/
+#if ! defined( TONE_FREQUENCY_CUTOFF_15 )
+  #define TONE_FREQUENCY_CUTOFF_15 (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_14 )
+  #define TONE_FREQUENCY_CUTOFF_14 (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_13 )
+  #define TONE_FREQUENCY_CUTOFF_13 (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_12 )
+  #define TONE_FREQUENCY_CUTOFF_12 (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_11 )
+  #define TONE_FREQUENCY_CUTOFF_11 (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_10 )
+  #define TONE_FREQUENCY_CUTOFF_10 (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_9 )
+  #define TONE_FREQUENCY_CUTOFF_9  (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_8 )
+  #define TONE_FREQUENCY_CUTOFF_8  (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_7 )
+  #define TONE_FREQUENCY_CUTOFF_7  (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_6 )
+  #define TONE_FREQUENCY_CUTOFF_6  (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_5 )
+  #define TONE_FREQUENCY_CUTOFF_5  (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_4 )
+  #define TONE_FREQUENCY_CUTOFF_4  (0)
+#endif
+#if ! defined( TONE_FREQUENCY_CUTOFF_3 )
+  #define TONE_FREQUENCY_CUTOFF_3  (0)
+#endif
+
+
+/*=============================================================================
+  Prescaler index, prescaler value, and output compare value for a
+  frequency.  Only meant for constants; Tone.cpp does the same thing at run
+  time with a table.
+=============================================================================*/
+
+#define TONE_PRESCALE_INDEX(f)  ( \
+    (f) <= TONE_FREQUENCY_CUTOFF_15 ? 15 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_14 ? 14 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_13 ? 13 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_12 ? 12 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_11 ? 11 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_10 ? 10 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_9  ?  9 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_8  ?  8 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_7  ?  7 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_6  ?  6 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_5  ?  5 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_4  ?  4 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_3  ?  3 : \
+    (f) <= TONE_FREQUENCY_CUTOFF_2  ?  2 : 1 )
+
+#if TONETIMER_NUMBER_PRESCALERS == 15
+#define TONE_PRESCALER_VALUE(i)  ( \
+    (i) == 15 ? TONETIMER_(PRESCALER_VALUE_15) : \
+    (i) == 14 ? TONETIMER_(PRESCALER_VALUE_14) : \
+    (i) == 13 ? TONETIMER_(PRESCALER_VALUE_13) : \
+    (i) == 12 ? TONETIMER_(PRESCALER_VALUE_12) : \
+    (i) == 11 ? TONETIMER_(PRESCALER_VALUE_11) : \
+    (i) == 10 ? TONETIMER_(PRESCALER_VALUE_10) : \
+    (i) ==  9 ? TONETIMER_(PRESCALER_VALUE_9)  : \
+    (i) ==  8 ? TONETIMER_(PRESCALER_VALUE_8)  : \
+    (i) ==  7 ? TONETIMER_(PRESCALER_VALUE_7)  : \
+    (i) ==  6 ? TONETIMER_(PRESCALER_VALUE_6)  : \
+    (i) ==  5 ? TONETIMER_(PRESCALER_VALUE_5)  : \
+    (i) ==  4 ? TONETIMER_(PRESCALER_VALUE_4)  : \
+    (i) ==  3 ? TONETIMER_(PRESCALER_VALUE_3)  : \
+    (i) ==  2 ? TONETIMER_(PRESCALER_VALUE_2)  : TONETIMER_(PRESCALER_VALUE_1) )
+#else
+#define TONE_PRESCALER_VALUE(i)  ( \
+    (i) ==  5 ? TONETIMER_(PRESCALER_VALUE_5)  : \
+    (i) ==  4 ? TONETIMER_(PRESCALER_VALUE_4)  : \
+    (i) ==  3 ? TONETIMER_(PRESCALER_VALUE_3)  : \
+    (i) ==  2 ? TONETIMER_(PRESCALER_VALUE_2)  : TONETIMER_(PRESCALER_VALUE_1) )
+#endif
+
+// Rounded to the nearest count
+#define TONE_OCR(f)  ( ((F_CPU / ((unsigned long)(f) * TONE_PRESCALER_VALUE( TONE_PRESCALE_INDEX( f ) ))) + 1L) / 2L - 1L )
+
+// The prescalers are all powers of two
+#define TONE_LOG2(v)  ( \
+    (v) >= 16384 ? 14 : (v) >= 8192 ? 13 : (v) >= 4096 ? 12 : (v) >= 2048 ? 11 : \
+    (v) >= 1024 ? 10 : (v) >= 512 ? 9 : (v) >= 256 ? 8 : (v) >= 128 ? 7 : \
+    (v) >= 64 ? 6 : (v) >= 32 ? 5 : (v) >= 16 ? 4 : (v) >= 8 ? 3 : \
+    (v) >= 4 ? 2 : (v) >= 2 ? 1 : 0 )
+
+
+/*=============================================================================
+  tone with a constant frequency goes straight to the hardware set-up with
+  the prescaler and compare value worked out by the compiler.  Anything else
+  (including a frequency of zero, which stops the tone) goes through the
+  table in Tone.cpp.
+=============================================================================*/
+
+void toneStart( uint8_t _pin, unsigned int frequency, unsigned long duration, uint8_t csi, tonetimer_(ocr_t) ocr );
+void toneVariable( uint8_t _pin, unsigned int frequency, unsigned long duration );
+void noTone( uint8_t _pin = 255 );
+
+__attribute__((always_inline)) static inline void tone( uint8_t _pin, unsigned int frequency, unsigned long duration = 0 )
+{
+  if ( __builtin_constant_p( frequency ) && (frequency >= TONE_LOWEST_FREQUENCY) )
+    toneStart( _pin, frequency, duration, TONE_PRESCALE_INDEX( frequency ), TONE_OCR( frequency ) );
+  else
+    toneVariable( _pin, frequency, duration );
+}
+
+
+#endif
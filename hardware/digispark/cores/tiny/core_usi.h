@@ -0,0 +1,80 @@
+/*==============================================================================
+
+  core_usi.h - Veneer for the Universal Serial Interface in three-wire (SPI
+      master) mode.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#ifndef core_usi_h
+#define core_usi_h
+
+#include <avr/io.h>
+
+#include "core_build_options.h"
+#include "core_pins.h"
+
+
+/*=============================================================================
+  The USI is clocked by software strobes.  Each pair of writes to USICR
+  raises USCK (the slave samples DO) then lowers it while shifting USIDR
+  (DO changes, DI is sampled).  That is SPI mode 0, MSB first, with the
+  clock idling low.  Fully unrolled each bit takes two out instructions so
+  USCK runs at F_CPU / 4 (a little over 4 MHz on a Digispark).
+
+  The USI is shared with TinyWireM.  Don't mix I2C and the functions below
+  without calling USI_Disable in between.
+=============================================================================*/
+
+#if defined( CORE_USI_DO_PIN )
+
+#define USI_THREE_WIRE_CLOCK_HIGH   ( _BV( USIWM0 ) | _BV( USITC ) )
+#define USI_THREE_WIRE_CLOCK_LOW    ( _BV( USIWM0 ) | _BV( USITC ) | _BV( USICLK ) )
+
+__attribute__((always_inline)) static inline void USI_EnableThreeWire( void )
+{
+  USICR = _BV( USIWM0 );
+}
+
+__attribute__((always_inline)) static inline void USI_Disable( void )
+{
+  USICR = 0;
+}
+
+__attribute__((always_inline)) static inline uint8_t USI_Transfer( uint8_t data )
+{
+  uint8_t hi = USI_THREE_WIRE_CLOCK_HIGH;
+  uint8_t lo = USI_THREE_WIRE_CLOCK_LOW;
+
+  USIDR = data;
+
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+  USICR = hi;  USICR = lo;
+
+  return( USIDR );
+}
+
+#endif
+
+
+#endif
@@ -1,13 +1,19 @@
 #include <WProgram.h>
 
+// weak so the scheduler is only linked when a sketch or library uses it
+extern "C" uint8_t schedulerRun(void) __attribute__((weak));
+
 int main(void)
 {
 	init();
 
 	setup();
     
-	for (;;)
+	for (;;) {
 		loop();
+		if (schedulerRun)
+			schedulerRun();
+	}
         
 	return 0;
 }
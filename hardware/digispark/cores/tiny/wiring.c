@@ -26,6 +26,8 @@
   Modified 20-11-2010 - B.Cook - Rewritten to use the various Veneers.
 */
 
+#include <avr/sleep.h>
+
 #include "core_build_options.h"
 #include "core_adc.h"
 #include "core_timers.h"
@@ -86,6 +88,39 @@ volatile unsigned long millis_timer_overflow_count = 0;
 volatile unsigned long millis_timer_millis = 0;
 static unsigned char millis_timer_fract = 0;
 
+// called from the overflow interrupt with the new millis value.  set by
+// code that needs a regular tick (the scheduler in wiring_scheduler.c).
+void (* volatile millis_timer_hook)(unsigned long m) = 0;
+
+#if (F_CPU % 1000000L) != 0
+// the clock is not a whole number of MHz (16.5 MHz on the Digispark) so a timer
+// tick is not a whole number of microseconds.  the overflow handler keeps a
+// running count of microseconds, carrying the fraction like millis does.  the
+// fraction is in 1/(F_CPU / 500000) us units (1/33 us at 16.5 MHz).
+#if (F_CPU % 500000L) != 0
+  #error micros() needs F_CPU to be a multiple of 500 KHz.
+#endif
+#define MICROS_HAS_FRACTION 1
+#define MICROS_DIVISOR (F_CPU / 500000L)
+#define MICROS_INC ((MillisTimer_Prescale_Value * 256L * 2) / MICROS_DIVISOR)
+#define MICROS_FRACT_INC ((MillisTimer_Prescale_Value * 256L * 2) % MICROS_DIVISOR)
+
+// microseconds per timer tick as whole + fraction / 256.  3 + 225/256 at 16.5 MHz,
+// within 0.03 us over a full count.  only needs 8 x 8 bit multiplies.
+#define MICROS_TICK_WHOLE ((MillisTimer_Prescale_Value * 2) / MICROS_DIVISOR)
+#define MICROS_TICK_FRACT ((((MillisTimer_Prescale_Value * 2 * 256L) + (MICROS_DIVISOR / 2)) / MICROS_DIVISOR) - (MICROS_TICK_WHOLE * 256))
+
+volatile unsigned long millis_timer_micros = 0;
+static unsigned char millis_timer_micros_fract = 0;
+
+static inline uint16_t microsFromCount(uint8_t t)
+{
+  return (t * (uint16_t)MICROS_TICK_WHOLE) + (((uint16_t)t * (uint16_t)MICROS_TICK_FRACT) >> 8);
+}
+#else
+#define MICROS_HAS_FRACTION 0
+#endif
+
 // bluebie changed isr to noblock so it wouldn't mess up USB libraries
 ISR(MILLISTIMER_OVF_vect, ISR_NOBLOCK)
 {
@@ -119,6 +154,24 @@ ISR(MILLISTIMER_OVF_vect, ISR_NOBLOCK)
   millis_timer_fract = f;
   millis_timer_millis = m;
   millis_timer_overflow_count++;
+
+#if MICROS_HAS_FRACTION
+  m = millis_timer_micros + MICROS_INC;
+  f = millis_timer_micros_fract + MICROS_FRACT_INC;
+  if (f >= MICROS_DIVISOR)
+  {
+    f -= MICROS_DIVISOR;
+    m += 1;
+  }
+  millis_timer_micros_fract = f;
+  millis_timer_micros = m;
+#endif
+
+  {
+    void (*hook)(unsigned long) = millis_timer_hook;
+    if (hook)
+      hook(millis_timer_millis);
+  }
 }
 
 unsigned long millis()
@@ -141,21 +194,126 @@ unsigned long micros()
   uint8_t oldSREG = SREG, t;
   
   cli();
+#if MICROS_HAS_FRACTION
+  m = millis_timer_micros;
+#else
   m = millis_timer_overflow_count;
+#endif
   t = MillisTimer_GetCount();
   
   if (MillisTimer_IsOverflowSet() && (t < 255))
+#if MICROS_HAS_FRACTION
+    m += MICROS_INC;
+#else
     m++;
+#endif
 
   SREG = oldSREG;
   
-#if (MillisTimer_Prescale_Value >= clockCyclesPerMicrosecond())
+#if MICROS_HAS_FRACTION
+  return m + microsFromCount(t);
+#elif (MillisTimer_Prescale_Value >= clockCyclesPerMicrosecond())
   return ((m << 8) + t) * (MillisTimer_Prescale_Value / clockCyclesPerMicrosecond());
 #else
   return ((m << 8) + t) / (clockCyclesPerMicrosecond() / MillisTimer_Prescale_Value);
 #endif
 }
 
+// the low 16 bits of micros() with 16 bit arithmetic.  good for timing
+// anything shorter than 65 ms (pulse widths, for example) from an ISR.
+uint16_t micros16(void)
+{
+  uint16_t m;
+  uint8_t oldSREG = SREG, t;
+
+  cli();
+#if MICROS_HAS_FRACTION
+  m = (uint16_t)millis_timer_micros;
+#else
+  m = (uint16_t)millis_timer_overflow_count;
+#endif
+  t = MillisTimer_GetCount();
+
+  if (MillisTimer_IsOverflowSet() && (t < 255))
+#if MICROS_HAS_FRACTION
+    m += MICROS_INC;
+#else
+    m++;
+#endif
+
+  SREG = oldSREG;
+
+#if MICROS_HAS_FRACTION
+  return m + microsFromCount(t);
+#elif (MillisTimer_Prescale_Value >= clockCyclesPerMicrosecond())
+  return ((m << 8) + t) * (MillisTimer_Prescale_Value / clockCyclesPerMicrosecond());
+#else
+  return ((m << 8) + t) / (clockCyclesPerMicrosecond() / MillisTimer_Prescale_Value);
+#endif
+}
+
+// the raw millis timer count (one tick every MillisTimer_Prescale_Value cycles).
+// no conversion at all; use ticksToMicroseconds() on the difference of two
+// readings.
+unsigned long ticks(void)
+{
+  unsigned long m;
+  uint8_t oldSREG = SREG, t;
+
+  cli();
+  m = millis_timer_overflow_count;
+  t = MillisTimer_GetCount();
+
+  if (MillisTimer_IsOverflowSet() && (t < 255))
+    m++;
+
+  SREG = oldSREG;
+
+  return (m << 8) + t;
+}
+
+// the low 16 bits of ticks().  cheap enough to timestamp edges in an ISR;
+// the difference of two readings is good up to 65535 ticks (254 ms at
+// 16.5 MHz).
+uint16_t ticks16(void)
+{
+  uint16_t m;
+  uint8_t oldSREG = SREG, t;
+
+  cli();
+  m = (uint8_t)millis_timer_overflow_count;
+  t = MillisTimer_GetCount();
+
+  if (MillisTimer_IsOverflowSet() && (t < 255))
+    m++;
+
+  SREG = oldSREG;
+
+  return (m << 8) + t;
+}
+
+// sleep until the next interrupt.  idle mode leaves the timers, USI, ADC,
+// and pin change / INT0 interrupts running so V-USB and everything else carry
+// on; waking adds four cycles to the response time of the interrupt that
+// woke us, about what an interrupt arriving during a call or 32 bit
+// instruction costs anyway.  does nothing with interrupts disabled (we
+// would never wake up).
+void idle(void)
+{
+  if (SREG & _BV(SREG_I))
+  {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+  }
+}
+
+// the millis timer interrupt wakes us at least this often so sleeping is
+// safe while more than this much of the delay is left.  the last bit is
+// spun so the delay ends on time.
+#define DELAY_SLEEP_MIN_MS ((MICROSECONDS_PER_MILLIS_OVERFLOW / 1000) + 2)
+
 void delay(unsigned long ms)
 {
   uint16_t start = (uint16_t)micros();
@@ -165,6 +323,11 @@ void delay(unsigned long ms)
       ms--;
       start += 1000;
     }
+#if DELAY_USES_IDLE_SLEEP
+    else if (ms >= DELAY_SLEEP_MIN_MS) {
+      idle();
+    }
+#endif
   }
 }
 
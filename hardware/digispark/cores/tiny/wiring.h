@@ -145,6 +145,17 @@ analogReference constants for ATmega168.  These are NOT correct for the ATtiny84
 #define clockCyclesToMicroseconds(a) ( ((a) * 1000L) / (F_CPU / 1000L) )
 #define microsecondsToClockCycles(a) ( ((a) * (F_CPU / 1000L)) / 1000L )
 
+// the millis timer tick used by ticks()
+#if F_CPU >= 3000000L
+  #define clockCyclesPerTick() ( MS_TIMER_TICK_EVERY_X_CYCLES )
+#else
+  #define clockCyclesPerTick() ( 8 )
+#endif
+// t * 2 * cycles per tick / cycles per half microsecond; going through
+// clockCyclesToMicroseconds() would multiply by 1000 and overflow 32 bits
+// after about a quarter of a second of ticks
+#define ticksToMicroseconds(t) ( ((t) * (2 * clockCyclesPerTick())) / (F_CPU / 500000L) )
+
 #define lowByte(w) ((uint8_t) ((w) & 0xff))
 #define highByte(w) ((uint8_t) ((w) >> 8))
 
@@ -170,15 +181,126 @@ int analogRead(uint8_t);
 void analogReference(uint8_t mode);
 void analogWrite(uint8_t, int);
 
+// Interrupt driven conversions (wiring_analog_async.c)
+typedef void (*analogCallback_t)(uint8_t channel, uint16_t value);
+uint8_t analogStart(uint8_t pin);
+uint8_t analogDone(void);
+int analogResult(void);
+void analogOnComplete(analogCallback_t callback);
+int analogReadNoiseReduced(uint8_t pin);
+void analogScanStart(const uint8_t* pins, uint8_t count);
+void analogScanStop(void);
+uint8_t analogScanAvailable(uint8_t index);
+int analogScanRead(uint8_t index);
+
+#define ANALOG_FILTER_NONE      0
+#define ANALOG_FILTER_AVERAGE   1
+#define ANALOG_FILTER_IIR       2
+
+uint8_t analogOversampleStart(uint8_t pin, uint8_t extraBits, uint8_t prescaler);
+void analogOversampleFilter(uint8_t filter, uint8_t strength);
+void analogOversampleStop(void);
+uint8_t analogOversampleAvailable(void);
+uint16_t analogOversampleRead(void);
+
 unsigned long millis(void);
 unsigned long micros(void);
+uint16_t micros16(void);
+unsigned long ticks(void);
+uint16_t ticks16(void);
 void delay(unsigned long);
+void idle(void);
+
+// Software timers (wiring_scheduler.c).  Callbacks run from schedulerRun,
+// which main calls after every loop().
+typedef void (*schedulerCallback_t)(void* arg);
+typedef struct schedulerTimer_s
+{
+  struct schedulerTimer_s* next;
+  schedulerCallback_t callback;
+  void* arg;
+  uint16_t expires;
+  uint16_t period;
+  uint8_t state;
+}
+schedulerTimer_t;
+
+void schedulerStart(schedulerTimer_t* timer, schedulerCallback_t callback, void* arg, uint16_t delay, uint16_t period);
+void schedulerStop(schedulerTimer_t* timer);
+uint8_t schedulerPending(schedulerTimer_t* timer);
+uint8_t schedulerRun(void);
 void delayMicroseconds(unsigned int us);
 unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout);
 
+// Background pulse measurement (wiring_pulse_async.c)
+typedef void (*pulseCallback_t)(uint8_t pin, uint16_t widthTicks);
+uint8_t pulseStart(uint8_t pin, uint8_t state);
+void pulseStop(uint8_t pin);
+uint8_t pulseAvailable(uint8_t pin);
+unsigned long pulseRead(uint8_t pin);
+uint16_t pulseReadTicks(uint8_t pin);
+void pulseOnComplete(pulseCallback_t callback);
+
+// Free RAM and high-water marks (wiring_memory.c).  Using any of these
+// paints the unused RAM at startup so memoryStats can see how far the
+// stack and heap have ever reached.
+typedef struct
+{
+  size_t free;            // between the top of the heap and the stack
+  size_t largestBlock;    // largest malloc that would succeed now
+  size_t unused;          // never touched by the stack or the heap
+  size_t heapMax;         // deepest the heap has grown
+  size_t stackMax;        // deepest the stack has grown
+}
+memoryStats_t;
+
+size_t memoryFree(void);
+size_t memoryLargestBlock(void);
+void memoryStats(memoryStats_t* stats);
+
+// Pool allocator statistics (wiring_pool.c), one size class at a time
+// starting with 0; returns 0 past the last class or with the pool off.
+typedef struct
+{
+  uint16_t size;          // bytes per block
+  uint8_t blocks;
+  uint8_t used;
+  uint8_t maxUsed;
+  uint8_t full;           // requests that found the class empty (up to 255)
+}
+poolStats_t;
+
+uint8_t poolStats(uint8_t sizeClass, poolStats_t* stats);
+
+// Multi-voice tone synthesis on the user timer (wiring_synth.c).  The
+// frequency of a voice is set as a phase increment per sample;
+// synthSetFrequency converts Hz (at compile time for a constant).
+#if ! defined( SYNTH_VOICES )
+  #define SYNTH_VOICES 4
+#endif
+#if ! defined( SYNTH_OVERFLOWS_PER_SAMPLE )
+  #define SYNTH_OVERFLOWS_PER_SAMPLE 4
+#endif
+#define SYNTH_SAMPLE_RATE (F_CPU / (256L * SYNTH_OVERFLOWS_PER_SAMPLE))
+#define SYNTH_INCREMENT_SCALE ((unsigned long)((4294967296.0 * SYNTH_OVERFLOWS_PER_SAMPLE) / F_CPU + 0.5))
+#define synthFrequencyToIncrement(f) ((uint16_t)(((unsigned long)(f) * SYNTH_INCREMENT_SCALE + 128) >> 8))
+#define SYNTH_SAWTOOTH ((const int8_t*)0)
+extern const int8_t synthSine[256];
+uint8_t synthBegin(uint8_t pin);
+void synthEnd(void);
+void synthSetVoice(uint8_t voice, const int8_t* wave, uint8_t attenuation);
+void synthSetIncrement(uint8_t voice, uint16_t increment);
+#define synthSetFrequency(voice,f) synthSetIncrement((voice), synthFrequencyToIncrement(f))
+
 void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val);
 uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder);
 
+// SPI master (mode 0, MSB first) on the USI pins
+void usiBegin(void);
+void usiEnd(void);
+uint8_t usiTransfer(uint8_t data);
+void usiTransferBuffer(void *buf, size_t count);
+
 void attachInterrupt(uint8_t, void (*)(void), int mode);
 void detachInterrupt(uint8_t);
 
@@ -189,4 +311,7 @@ void loop(void);
 } // extern "C"
 #endif
 
+#include "core_digital.h"
+#include "core_interrupts.h"
+
 #endif
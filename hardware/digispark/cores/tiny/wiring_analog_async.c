@@ -0,0 +1,489 @@
+/*==============================================================================
+
+  wiring_analog_async.c - Interrupt driven analog conversions.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "wiring_private.h"
+#include "core_adc.h"
+#include "core_pins.h"
+
+#if HAVE_ADC
+
+extern uint8_t analog_reference;
+
+/*=============================================================================
+  Everything here runs from the ADC conversion complete interrupt.  Nothing
+  in this file is linked unless one of the functions below is called so
+  analogRead is unaffected.  analogRead must not be called while a scan is
+  running or while an analogStart conversion is pending; it would steal the
+  conversion.
+
+  A single conversion is started with analogStart and collected with
+  analogDone / analogResult (or the callback).
+
+  A scan converts each channel in the list in turn, forever, and keeps the
+  last ANALOG_SCAN_DEPTH results of each channel.  At the /128 prescaler
+  one conversion takes about 110 us so each channel of a four channel scan
+  is sampled roughly every 440 us.
+=============================================================================*/
+
+#if ! defined( ANALOG_SCAN_CHANNELS )
+  #define ANALOG_SCAN_CHANNELS  4
+#endif
+
+#if ! defined( ANALOG_SCAN_DEPTH )
+  #define ANALOG_SCAN_DEPTH     4
+#endif
+
+#if (ANALOG_SCAN_DEPTH & (ANALOG_SCAN_DEPTH - 1)) != 0
+  #error ANALOG_SCAN_DEPTH must be a power of two.
+#endif
+
+typedef struct
+{
+  uint16_t        sample[ANALOG_SCAN_DEPTH];
+  uint8_t         head;
+  uint8_t         tail;
+}
+analog_ring_t;
+
+static analogCallback_t volatile  analog_callback;
+
+static volatile uint8_t           analog_single_channel;
+static volatile uint8_t           analog_single_done;
+static volatile uint16_t          analog_single_value;
+
+static uint8_t                    analog_scan_channel[ANALOG_SCAN_CHANNELS];
+static volatile uint8_t           analog_scan_count;
+static uint8_t                    analog_scan_index;
+static analog_ring_t              analog_scan_ring[ANALOG_SCAN_CHANNELS];
+
+#define ANALOG_AVERAGE_MAX  8
+#define ANALOG_AVERAGE_SHIFT_MAX  3   // log2( ANALOG_AVERAGE_MAX )
+#define ANALOG_IIR_SHIFT_MAX      8   // 16 bit results shifted this far still fit the accumulator
+
+static volatile uint16_t          analog_os_samples;
+static uint16_t                   analog_os_left;
+static uint32_t                   analog_os_sum;
+static uint8_t                    analog_os_bits;
+static uint8_t                    analog_os_channel;
+static volatile uint8_t           analog_os_fresh;
+static volatile uint16_t          analog_os_value;
+static uint8_t                    analog_os_filter;
+static uint8_t                    analog_os_strength;
+static uint16_t                   analog_os_average[ANALOG_AVERAGE_MAX];
+static uint8_t                    analog_os_average_index;
+static uint8_t                    analog_os_primed;
+static uint32_t                   analog_os_accumulator;
+
+
+static uint8_t analogPinToChannel( uint8_t pin )
+{
+  #if defined( CORE_ANALOG_FIRST )
+    if ( pin >= CORE_ANALOG_FIRST ) pin -= CORE_ANALOG_FIRST; // allow for channel or pin numbers
+  #endif
+  return( pin );
+}
+
+static void analogStartChannel( uint8_t channel )
+{
+  ADC_SetVoltageReference( analog_reference );
+  ADC_SetInputChannel( channel );
+  ADC_EnableInterrupt();
+  ADC_StartConversion();
+}
+
+
+/*=============================================================================
+  Single conversions
+=============================================================================*/
+
+uint8_t analogStart( uint8_t pin )
+{
+  if ( analog_scan_count || analog_os_samples || ADC_ConversionInProgress() )
+    return( 0 );
+
+  analog_single_channel = analogPinToChannel( pin );
+  analog_single_done = 0;
+  analogStartChannel( analog_single_channel );
+  return( 1 );
+}
+
+uint8_t analogDone( void )
+{
+  return( analog_single_done );
+}
+
+int analogResult( void )
+{
+  if ( ! analog_single_done )
+    return( -1 );
+  return( analog_single_value );
+}
+
+void analogOnComplete( analogCallback_t callback )
+{
+  analog_callback = callback;
+}
+
+/*
+  Convert with the processor in ADC Noise Reduction sleep.  The I/O clock
+  is stopped while asleep so the millis timer loses up to one conversion
+  time (about 110 us) per call.  Any other enabled interrupt (V-USB, pin
+  change) wakes the processor early; it goes straight back to sleep until
+  the conversion is finished.
+*/
+
+int analogReadNoiseReduced( uint8_t pin )
+{
+  if ( analog_scan_count || analog_os_samples )
+    return( -1 );
+
+  while ( ADC_ConversionInProgress() );
+
+  analog_single_channel = analogPinToChannel( pin );
+  analog_single_done = 0;
+
+  ADC_SetVoltageReference( analog_reference );
+  ADC_SetInputChannel( analog_single_channel );
+  ADC_EnableInterrupt();
+
+  // Entering the sleep mode starts the conversion.
+  set_sleep_mode( SLEEP_MODE_ADC );
+
+  cli();
+  while ( ! analog_single_done )
+  {
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    cli();
+  }
+  sei();
+
+  return( analog_single_value );
+}
+
+
+/*=============================================================================
+  Background scan
+=============================================================================*/
+
+void analogScanStart( const uint8_t* pins, uint8_t count )
+{
+  uint8_t i;
+
+  analogOversampleStop();
+  analogScanStop();
+
+  if ( count > ANALOG_SCAN_CHANNELS )
+    count = ANALOG_SCAN_CHANNELS;
+
+  if ( count == 0 )
+    return;
+
+  while ( ADC_ConversionInProgress() );
+
+  for ( i = 0; i < count; ++i )
+  {
+    analog_scan_channel[i] = analogPinToChannel( pins[i] );
+    analog_scan_ring[i].head = 0;
+    analog_scan_ring[i].tail = 0;
+  }
+  analog_scan_index = 0;
+  analog_scan_count = count;
+
+  analogStartChannel( analog_scan_channel[0] );
+}
+
+void analogScanStop( void )
+{
+  uint8_t oldSREG = SREG;
+  cli();
+  analog_scan_count = 0;
+  ADC_DisableInterrupt();
+  SREG = oldSREG;
+
+  // Let the conversion that was running finish; its result is dropped.
+  while ( ADC_ConversionInProgress() );
+}
+
+uint8_t analogScanAvailable( uint8_t index )
+{
+  analog_ring_t* ring;
+  uint8_t oldSREG;
+  uint8_t rv;
+
+  if ( index >= ANALOG_SCAN_CHANNELS )
+    return( 0 );
+
+  ring = &analog_scan_ring[index];
+
+  oldSREG = SREG;
+  cli();
+  rv = ring->head - ring->tail;
+  SREG = oldSREG;
+
+  return( rv );
+}
+
+int analogScanRead( uint8_t index )
+{
+  analog_ring_t* ring;
+  uint8_t oldSREG;
+  int rv;
+
+  if ( index >= ANALOG_SCAN_CHANNELS )
+    return( -1 );
+
+  ring = &analog_scan_ring[index];
+
+  oldSREG = SREG;
+  cli();
+  if ( ring->head == ring->tail )
+  {
+    rv = -1;
+  }
+  else
+  {
+    rv = ring->sample[ring->tail & (ANALOG_SCAN_DEPTH - 1)];
+    ++ring->tail;
+  }
+  SREG = oldSREG;
+
+  return( rv );
+}
+
+
+/*=============================================================================
+  Oversampling.  One channel is converted continuously; every 4^n samples
+  are summed and shifted right by n giving a result with n extra bits
+  (10 + n bits in all).  That only works when there is at least an LSB of
+  noise on the input.  The decimated results can be smoothed further:
+
+    ANALOG_FILTER_AVERAGE   mean of the last 2^strength results (1 to 8)
+    ANALOG_FILTER_IIR       y += (x - y) / 2^strength (strength up to 8)
+
+  A strength past the limit is taken as the limit.
+
+  The datasheet wants the ADC clock between 50 and 200 KHz for full
+  resolution.  A faster prescaler gives more samples per second at the
+  cost of some accuracy in each one; 0 keeps the Arduino setting.
+  analogOversampleStop puts the Arduino prescaler back.
+=============================================================================*/
+
+uint8_t analogOversampleStart( uint8_t pin, uint8_t extraBits, uint8_t prescaler )
+{
+  if ( extraBits > 6 )
+    return( 0 );
+
+  analogScanStop();
+  analogOversampleStop();
+
+  if ( prescaler != 0 )
+    ADC_PrescalerSelect( (adc_ps_t) prescaler );
+
+  analog_os_channel = analogPinToChannel( pin );
+  analog_os_bits = extraBits;
+  analog_os_sum = 0;
+  analog_os_left = 1 << (2 * extraBits);
+  analog_os_fresh = 0;
+  analog_os_primed = 0;
+  analog_os_samples = analog_os_left;
+
+  analogStartChannel( analog_os_channel );
+  return( 1 );
+}
+
+void analogOversampleFilter( uint8_t filter, uint8_t strength )
+{
+  uint8_t oldSREG;
+
+  if ( (filter == ANALOG_FILTER_AVERAGE) && (strength > ANALOG_AVERAGE_SHIFT_MAX) )
+    strength = ANALOG_AVERAGE_SHIFT_MAX;
+  else if ( (filter == ANALOG_FILTER_IIR) && (strength > ANALOG_IIR_SHIFT_MAX) )
+    strength = ANALOG_IIR_SHIFT_MAX;
+
+  oldSREG = SREG;
+  cli();
+  analog_os_filter = filter;
+  analog_os_strength = strength;
+  analog_os_primed = 0;
+  SREG = oldSREG;
+}
+
+void analogOversampleStop( void )
+{
+  uint8_t oldSREG;
+
+  if ( ! analog_os_samples )
+    return;
+
+  oldSREG = SREG;
+  cli();
+  analog_os_samples = 0;
+  ADC_DisableInterrupt();
+  SREG = oldSREG;
+
+  while ( ADC_ConversionInProgress() );
+  ADC_PrescalerSelect( ADC_ARDUINO_PRESCALER );
+}
+
+uint8_t analogOversampleAvailable( void )
+{
+  return( analog_os_fresh );
+}
+
+uint16_t analogOversampleRead( void )
+{
+  uint8_t oldSREG;
+  uint16_t rv;
+
+  oldSREG = SREG;
+  cli();
+  rv = analog_os_value;
+  analog_os_fresh = 0;
+  SREG = oldSREG;
+
+  return( rv );
+}
+
+static uint16_t analogOversampleSmooth( uint16_t x )
+{
+  uint8_t i;
+  uint32_t sum;
+
+  switch ( analog_os_filter )
+  {
+    case ANALOG_FILTER_AVERAGE:
+      if ( ! analog_os_primed )
+      {
+        for ( i = 0; i < ANALOG_AVERAGE_MAX; ++i )
+          analog_os_average[i] = x;
+        analog_os_average_index = 0;
+        analog_os_primed = 1;
+      }
+      analog_os_average[analog_os_average_index] = x;
+      analog_os_average_index = (analog_os_average_index + 1) & ((1 << analog_os_strength) - 1);
+      sum = 0;
+      for ( i = 0; i < (1 << analog_os_strength); ++i )
+        sum += analog_os_average[i];
+      return( sum >> analog_os_strength );
+
+    case ANALOG_FILTER_IIR:
+      if ( ! analog_os_primed )
+      {
+        analog_os_accumulator = (uint32_t) x << analog_os_strength;
+        analog_os_primed = 1;
+      }
+      analog_os_accumulator += x - (analog_os_accumulator >> analog_os_strength);
+      return( analog_os_accumulator >> analog_os_strength );
+  }
+  return( x );
+}
+
+
+/*=============================================================================
+  Conversion complete
+
+  Runs with interrupts enabled so USB is not held off by the smoothing or
+  the callback.  The ADC can't interrupt again until the next conversion
+  is started, so the result is stored and the next conversion started
+  first; only the smoothing and the callback can overlap a later
+  conversion.  Should one finish while they are still running (a slow
+  callback, or USB delaying things) its sample is kept but it gets no
+  smoothing or callback of its own, as in wiring_synth.c.
+=============================================================================*/
+
+static volatile uint8_t           analog_busy;
+
+ISR( ADC_vect, ISR_NOBLOCK )
+{
+  uint16_t value;
+  uint8_t channel;
+  uint32_t sum;
+  analogCallback_t callback;
+
+  value = ADC_GetDataRegister();
+
+  if ( analog_os_samples )
+  {
+    analog_os_sum += value;
+
+    if ( --analog_os_left != 0 )
+    {
+      ADC_StartConversion();
+      return;
+    }
+
+    sum = analog_os_sum;
+    analog_os_sum = 0;
+    analog_os_left = analog_os_samples;
+    channel = analog_os_channel;
+    ADC_StartConversion();
+  }
+  else if ( analog_scan_count )
+  {
+    analog_ring_t* ring = &analog_scan_ring[analog_scan_index];
+
+    // When the ring is full the oldest sample is dropped.
+    if ( (uint8_t)(ring->head - ring->tail) == ANALOG_SCAN_DEPTH )
+      ++ring->tail;
+    ring->sample[ring->head & (ANALOG_SCAN_DEPTH - 1)] = value;
+    ++ring->head;
+
+    channel = analog_scan_channel[analog_scan_index];
+
+    if ( ++analog_scan_index >= analog_scan_count )
+      analog_scan_index = 0;
+
+    ADC_SetInputChannel( analog_scan_channel[analog_scan_index] );
+    ADC_StartConversion();
+  }
+  else
+  {
+    channel = analog_single_channel;
+    analog_single_value = value;
+    analog_single_done = 1;
+    ADC_DisableInterrupt();
+  }
+
+  if ( analog_busy )
+    return;
+  analog_busy = 1;
+
+  if ( analog_os_samples )
+  {
+    value = analogOversampleSmooth( sum >> analog_os_bits );
+    analog_os_value = value;
+    analog_os_fresh = 1;
+  }
+
+  callback = analog_callback;
+  if ( callback )
+    callback( channel, value );
+
+  analog_busy = 0;
+}
+
+#endif
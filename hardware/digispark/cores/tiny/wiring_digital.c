@@ -25,11 +25,15 @@
   Modified 14-10-2009 for attiny45 Saposoft
 */
 
+// The functions below are the run-time (non-constant pin) path.  Keep the
+// inline versions from core_digital.h out of this file.
+#define CORE_DIGITAL_OUT_OF_LINE
+
 #include "wiring_private.h"
 #include "pins_arduino.h"
 #include "core_pins.h"
 #include "core_timers.h"
-#include "PwmTimer.h"
+#include "core_digital.h"
 
 void pinMode(uint8_t pin, uint8_t mode)
 {
@@ -55,56 +59,6 @@ void pinMode(uint8_t pin, uint8_t mode)
 	}
 }
 
-// Forcing this inline keeps the callers from having to push their own stuff
-// on the stack. It is a good performance win and only takes 1 more byte per
-// user than calling. (It will take more bytes on the 168.)
-//
-// But shouldn't this be moved into pinMode? Seems silly to check and do on
-// each digitalread or write.
-//
-__attribute__((always_inline)) static inline void turnOffPWM( uint8_t pin )
-{
-  #if CORE_PWM_COUNT >= 1
-    if ( pin == CORE_PWM0_PIN )
-    {
-      Pwm0_SetCompareOutputMode( Pwm0_Disconnected );
-    }
-    else
-  #endif
-
-  #if CORE_PWM_COUNT >= 2
-    if ( pin == CORE_PWM1_PIN )
-    {
-      Pwm1_SetCompareOutputMode( Pwm1_Disconnected );
-    }
-    else
-  #endif
-
-  #if CORE_PWM_COUNT >= 3
-    if ( pin == CORE_PWM2_PIN )
-    {
-      Pwm2_SetCompareOutputMode( Pwm2_Disconnected );
-    }
-    else
-  #endif
-
-  #if CORE_PWM_COUNT >= 4
-    if ( pin == CORE_PWM3_PIN )
-    {
-      Pwm3_SetCompareOutputMode( Pwm3_Disconnected );
-    }
-    else
-  #endif
-
-  #if CORE_PWM_COUNT >= 5
-  #error Only 4 PWM pins are supported.  Add more conditions.
-  #endif
-
-    {
-    }
-
-}
-
 void digitalWrite(uint8_t pin, uint8_t val)
 {
 	uint8_t bit = digitalPinToBitMask(pin);
@@ -0,0 +1,197 @@
+/*==============================================================================
+
+  wiring_memory.c - Free RAM and stack / heap high-water marks.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/io.h>
+
+#include "wiring_private.h"
+
+
+/*=============================================================================
+  The heap grows up from the end of the static data and the stack grows
+  down from the end of RAM.  Before anything runs, everything between the
+  two is painted with MEMORY_CANARY.  Later, the longest unbroken run of
+  paint is the gap neither side has ever reached.  Below it is the heap's
+  high-water mark and above it the stack's.  A run of the canary value in
+  real data can fool this, but only by a few bytes, and only towards
+  reporting more use.
+
+  The paint is done from .init3, before the static data is set up.  It is
+  linked only when one of the functions below is used.
+
+  malloc's variables are weak references so nothing here pulls malloc into
+  a sketch that doesn't otherwise use it.  With the pool allocator enabled
+  (core_build_options.h) they aren't linked at all and malloc can only
+  hand out pool blocks, so the largest block comes from poolStats instead.
+=============================================================================*/
+
+#define MEMORY_CANARY   0xC5
+
+struct memory_freelist_s
+{
+  size_t                      sz;
+  struct memory_freelist_s*   nx;
+};
+
+extern char __heap_start;
+extern char* __brkval __attribute__((weak));
+extern struct memory_freelist_s* __flp __attribute__((weak));
+extern size_t __malloc_margin __attribute__((weak));
+
+void memoryPaint( void ) __attribute__((naked, used, section(".init3")));
+
+void memoryPaint( void )
+{
+  // Nothing is on the stack yet so the paint goes all the way to RAMEND.
+  // Plain registers only; there is no stack frame in here.
+  asm volatile
+  (
+    "ldi   r30, lo8(__heap_start)"            "\n\t"
+    "ldi   r31, hi8(__heap_start)"            "\n\t"
+    "ldi   r24, %[canary]"                    "\n\t"
+    "ldi   r25, hi8(%[end])"                  "\n\t"
+  "L%=loop: "
+    "st    Z+, r24"                           "\n\t"
+    "cpi   r30, lo8(%[end])"                  "\n\t"
+    "cpc   r31, r25"                          "\n\t"
+    "brne  L%=loop"                           "\n\t"
+    :
+    :
+      [canary] "M" ( MEMORY_CANARY ),
+      [end] "i" ( RAMEND + 1 )
+    :
+      "r24", "r25", "r30", "r31"
+  );
+}
+
+static char* memoryHeapTop( void )
+{
+  if ( (&__brkval != 0) && (__brkval != 0) )
+    return( __brkval );
+  return( &__heap_start );
+}
+
+size_t memoryFree( void )
+{
+  return( (char*) SP - memoryHeapTop() );
+}
+
+#if POOL_ENABLED
+
+size_t memoryLargestBlock( void )
+{
+  poolStats_t pool;
+  size_t largest;
+  uint8_t c;
+
+  largest = 0;
+
+  // The classes go smallest first; the last one with a block to spare
+  for ( c = 0; poolStats( c, &pool ); ++c )
+  {
+    if ( pool.used < pool.blocks )
+      largest = pool.size;
+  }
+
+  return( largest );
+}
+
+#else
+
+size_t memoryLargestBlock( void )
+{
+  struct memory_freelist_s* f;
+  size_t largest;
+  size_t margin;
+  size_t gap;
+
+  largest = 0;
+
+  // A freed block can be reused whole
+  if ( &__flp != 0 )
+  {
+    for ( f = __flp; f != 0; f = f->nx )
+    {
+      if ( f->sz > largest )
+        largest = f->sz;
+    }
+  }
+
+  // or the heap can grow up to __malloc_margin bytes short of the stack
+  // (less the two byte length malloc keeps in front of the block)
+  margin = (&__malloc_margin != 0) ? __malloc_margin : 32;
+  gap = memoryFree();
+
+  if ( gap > margin + sizeof(size_t) )
+  {
+    gap -= margin + sizeof(size_t);
+    if ( gap > largest )
+      largest = gap;
+  }
+
+  return( largest );
+}
+
+#endif
+
+void memoryStats( memoryStats_t* stats )
+{
+  uint8_t* p;
+  uint8_t* end;
+  uint8_t* run;
+  uint8_t* best;
+  size_t length;
+  size_t bestLength;
+
+  stats->free = memoryFree();
+  stats->largestBlock = memoryLargestBlock();
+
+  p = (uint8_t*) &__heap_start;
+  end = (uint8_t*) SP;
+
+  run = p;
+  best = p;
+  bestLength = 0;
+
+  // The scan takes thousands of cycles so interrupts stay on (USB would
+  // lose packets otherwise).  Anything an interrupt pushes below SP in the
+  // meantime is real stack use and is rightly counted.
+  while ( p <= end )
+  {
+    if ( *p != MEMORY_CANARY )
+    {
+      run = p + 1;
+    }
+    else
+    {
+      length = p + 1 - run;
+      if ( length > bestLength )
+      {
+        bestLength = length;
+        best = run;
+      }
+    }
+    ++p;
+  }
+
+  stats->unused = bestLength;
+  stats->heapMax = best - (uint8_t*) &__heap_start;
+  stats->stackMax = (uint8_t*) RAMEND - (best + bestLength - 1);
+}
@@ -0,0 +1,42 @@
+/*==============================================================================
+
+  wiring_memory_report.cpp - Text form of memoryStats.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include "WProgram.h"
+
+
+/*=============================================================================
+  One line, all in bytes, e.g.
+
+    free=301 largest=267 unused=288 heap=12 stack=37
+
+  Kept apart from wiring_memory.c so the numbers can be had without
+  pulling in printf.
+=============================================================================*/
+
+void memoryReport( Print& out )
+{
+  memoryStats_t stats;
+
+  memoryStats( &stats );
+
+  out.printf( F("free=%u largest=%u unused=%u heap=%u stack=%u\r\n"),
+      stats.free, stats.largestBlock, stats.unused, stats.heapMax, stats.stackMax );
+}
@@ -0,0 +1,105 @@
+/*==============================================================================
+
+  wiring_pin_change.c - Router for the pin change interrupts.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+
+#include "wiring_private.h"
+#include "core_interrupts.h"
+
+
+/*=============================================================================
+  Each slot is a weak reference.  A slot nobody filled resolves to zero and
+  its test is a compare against a link-time constant; a filled slot is a
+  plain rcall.  Nothing in here is linked unless PCINT0_HANDLER (or
+  PCINT1_HANDLER) is used.  The INT0 router is in WInterrupts.c so
+  attachInterrupt doesn't drag the pin change vector along (and collide
+  with V-USB).
+
+  The pin change vectors work out which pins changed since the last
+  interrupt (for all the pins on the port; each handler applies its own
+  mask) and pass that along with the port so the handlers don't each read
+  it at a different time.
+=============================================================================*/
+
+#if INTERRUPT_SLOTS != 4
+  #error Update the routers for the number of slots.
+#endif
+
+#define INTERRUPT_CALL_SLOTS(name,...)                        \
+  if ( name##Handler_0 ) name##Handler_0( __VA_ARGS__ );      \
+  if ( name##Handler_1 ) name##Handler_1( __VA_ARGS__ );      \
+  if ( name##Handler_2 ) name##Handler_2( __VA_ARGS__ );      \
+  if ( name##Handler_3 ) name##Handler_3( __VA_ARGS__ )
+
+
+/*=============================================================================
+  Pin change interrupt(s)
+=============================================================================*/
+
+#if defined( __AVR_ATtinyX5__ ) || defined( __AVR_ATtinyX4__ )
+
+extern void pcint0Handler_0( uint8_t changed, uint8_t now ) __attribute__((weak));
+extern void pcint0Handler_1( uint8_t changed, uint8_t now ) __attribute__((weak));
+extern void pcint0Handler_2( uint8_t changed, uint8_t now ) __attribute__((weak));
+extern void pcint0Handler_3( uint8_t changed, uint8_t now ) __attribute__((weak));
+
+static uint8_t pcint0_previous;
+
+ISR( PCINT0_vect )
+{
+  uint8_t now;
+  uint8_t changed;
+
+  #if defined( __AVR_ATtinyX4__ )
+    now = PINA;
+  #else
+    now = PINB;
+  #endif
+  changed = now ^ pcint0_previous;
+  pcint0_previous = now;
+
+  INTERRUPT_CALL_SLOTS( pcint0, changed, now );
+}
+
+#endif
+
+#if defined( __AVR_ATtinyX4__ )
+
+extern void pcint1Handler_0( uint8_t changed, uint8_t now ) __attribute__((weak));
+extern void pcint1Handler_1( uint8_t changed, uint8_t now ) __attribute__((weak));
+extern void pcint1Handler_2( uint8_t changed, uint8_t now ) __attribute__((weak));
+extern void pcint1Handler_3( uint8_t changed, uint8_t now ) __attribute__((weak));
+
+static uint8_t pcint1_previous;
+
+ISR( PCINT1_vect )
+{
+  uint8_t now;
+  uint8_t changed;
+
+  now = PINB;
+  changed = now ^ pcint1_previous;
+  pcint1_previous = now;
+
+  INTERRUPT_CALL_SLOTS( pcint1, changed, now );
+}
+
+#endif
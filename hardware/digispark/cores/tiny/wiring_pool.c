@@ -0,0 +1,225 @@
+/*==============================================================================
+
+  wiring_pool.c - Fixed-block pool behind malloc, free and realloc.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "core_build_options.h"
+#include "wiring_private.h"
+
+
+/*=============================================================================
+  Each size class is a run of equal blocks in one static region, smallest
+  class first, so the class a pointer belongs to follows from where it
+  is.  Freed blocks go on a list per class, linked through their first
+  two bytes; blocks that have never been handed out are taken from the
+  end of the used part of the run so nothing has to be set up at startup.
+  Allocating and freeing look at no more than the four classes.
+
+  Because the core library is linked ahead of avr-libc, the malloc, free
+  and realloc here replace avr-libc's for the whole sketch (operator new
+  and String included) when the pool is enabled in core_build_options.h.
+=============================================================================*/
+
+#define POOL_CLASSES      4
+
+#if POOL_ENABLED
+
+#define POOL_BYTES_1      ((uint16_t) POOL_SIZE_1 * POOL_BLOCKS_1)
+#define POOL_BYTES_2      ((uint16_t) POOL_SIZE_2 * POOL_BLOCKS_2)
+#define POOL_BYTES_3      ((uint16_t) POOL_SIZE_3 * POOL_BLOCKS_3)
+#define POOL_BYTES_4      ((uint16_t) POOL_SIZE_4 * POOL_BLOCKS_4)
+
+typedef struct
+{
+  void*       free;       // freed blocks
+  uint8_t     fresh;      // blocks never handed out start at this one
+  uint8_t     used;
+  uint8_t     maxUsed;
+  uint8_t     full;
+}
+pool_class_t;
+
+static uint8_t            pool_region[POOL_BYTES_1 + POOL_BYTES_2 + POOL_BYTES_3 + POOL_BYTES_4];
+static pool_class_t       pool_class[POOL_CLASSES];
+
+static const uint16_t     pool_size[POOL_CLASSES] PROGMEM =
+{
+  POOL_SIZE_1, POOL_SIZE_2, POOL_SIZE_3, POOL_SIZE_4
+};
+
+static const uint8_t      pool_blocks[POOL_CLASSES] PROGMEM =
+{
+  POOL_BLOCKS_1, POOL_BLOCKS_2, POOL_BLOCKS_3, POOL_BLOCKS_4
+};
+
+// where each class ends in pool_region
+static const uint16_t     pool_end[POOL_CLASSES] PROGMEM =
+{
+  POOL_BYTES_1,
+  POOL_BYTES_1 + POOL_BYTES_2,
+  POOL_BYTES_1 + POOL_BYTES_2 + POOL_BYTES_3,
+  POOL_BYTES_1 + POOL_BYTES_2 + POOL_BYTES_3 + POOL_BYTES_4
+};
+
+
+static uint8_t poolClassOf( void* ptr )
+{
+  uint16_t offset;
+  uint8_t c;
+
+  offset = (uint8_t*) ptr - pool_region;
+
+  for ( c = 0; c < POOL_CLASSES; ++c )
+  {
+    if ( offset < pgm_read_word( &pool_end[c] ) )
+      return( c );
+  }
+  return( POOL_CLASSES );
+}
+
+void* malloc( size_t size )
+{
+  pool_class_t* pc;
+  uint16_t blockSize;
+  uint8_t* p;
+  uint8_t c;
+  uint8_t oldSREG;
+
+  oldSREG = SREG;
+  cli();
+
+  for ( c = 0, pc = pool_class; c < POOL_CLASSES; ++c, ++pc )
+  {
+    blockSize = pgm_read_word( &pool_size[c] );
+
+    if ( size > blockSize )
+      continue;
+
+    if ( pc->free )
+    {
+      p = (uint8_t*) pc->free;
+      pc->free = *(void**) p;
+    }
+    else if ( pc->fresh < pgm_read_byte( &pool_blocks[c] ) )
+    {
+      p = pool_region + pgm_read_word( &pool_end[c] )
+          - (uint16_t) (pgm_read_byte( &pool_blocks[c] ) - pc->fresh) * blockSize;
+      ++pc->fresh;
+    }
+    else
+    {
+      // Try the next size up
+      if ( pc->full != 255 )
+        ++pc->full;
+      continue;
+    }
+
+    ++pc->used;
+    if ( pc->used > pc->maxUsed )
+      pc->maxUsed = pc->used;
+
+    SREG = oldSREG;
+    return( p );
+  }
+
+  SREG = oldSREG;
+  return( 0 );
+}
+
+void free( void* ptr )
+{
+  pool_class_t* pc;
+  uint8_t c;
+  uint8_t oldSREG;
+
+  if ( ptr == 0 )
+    return;
+
+  c = poolClassOf( ptr );
+  if ( c >= POOL_CLASSES )
+    return;
+
+  pc = &pool_class[c];
+
+  oldSREG = SREG;
+  cli();
+  *(void**) ptr = pc->free;
+  pc->free = ptr;
+  --pc->used;
+  SREG = oldSREG;
+}
+
+void* realloc( void* ptr, size_t size )
+{
+  uint16_t blockSize;
+  void* rv;
+
+  if ( ptr == 0 )
+    return( malloc( size ) );
+
+  blockSize = pgm_read_word( &pool_size[poolClassOf( ptr )] );
+
+  // It still fits; the block doesn't get any bigger by moving it
+  if ( size <= blockSize )
+    return( ptr );
+
+  rv = malloc( size );
+  if ( rv )
+  {
+    memcpy( rv, ptr, blockSize );
+    free( ptr );
+  }
+  return( rv );
+}
+
+uint8_t poolStats( uint8_t sizeClass, poolStats_t* stats )
+{
+  pool_class_t* pc;
+  uint8_t oldSREG;
+
+  if ( sizeClass >= POOL_CLASSES )
+    return( 0 );
+
+  pc = &pool_class[sizeClass];
+
+  oldSREG = SREG;
+  cli();
+  stats->size = pgm_read_word( &pool_size[sizeClass] );
+  stats->blocks = pgm_read_byte( &pool_blocks[sizeClass] );
+  stats->used = pc->used;
+  stats->maxUsed = pc->maxUsed;
+  stats->full = pc->full;
+  SREG = oldSREG;
+
+  return( 1 );
+}
+
+#else
+
+uint8_t poolStats( uint8_t sizeClass, poolStats_t* stats )
+{
+  return( 0 );
+}
+
+#endif
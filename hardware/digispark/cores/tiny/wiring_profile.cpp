@@ -0,0 +1,225 @@
+/*==============================================================================
+
+  wiring_profile.cpp - Sampling profiler on the millis timer.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+
+#include "core_build_options.h"
+#include "core_timers.h"
+#include "WProgram.h"
+
+
+/*=============================================================================
+  The millis timer's compare match B interrupt is not otherwise used (the
+  compare value only matters to analogWrite on the OCxB pin) so it fires
+  once per millis overflow, a little over 1 kHz at 16.5 MHz, without
+  touching the timer.  Each time, the address the interrupt returns to is
+  counted in a histogram of PROFILE_BUCKETS buckets spread over the range
+  given to profileBegin.  Over the whole flash a bucket is a few hundred
+  bytes; narrow the range to one function or two for per-instruction
+  counts.  When a bucket is full every count is halved.
+
+  profileReport writes the histogram as text, e.g.
+
+    #profile first=0x0000 step=256 buckets=32 outside=0
+    0x0100 112
+    0x0e00 891
+    #end
+
+  and hardware/digispark/tools/tinyprof.py turns that plus the sketch's
+  .elf into time per function.
+
+  The samples are locked to the millis timer, so code that runs in step
+  with it (the millis interrupt itself, a loop that waits for millis to
+  change) is over or under counted.  Interrupts that block (V-USB) are
+  never sampled while they run; their time shows up as the instruction
+  they interrupted.
+=============================================================================*/
+
+#if ! defined( PROFILE_BUCKETS )
+  #define PROFILE_BUCKETS     32
+#endif
+
+#define MillisTimer_(f)       TIMER_PASTE_A( Timer, TIMER_TO_USE_FOR_MILLIS, f )
+#define MILLISTIMER_(c)       TIMER_PASTE_A( TIMER, TIMER_TO_USE_FOR_MILLIS, c )
+
+#if TIMER_TO_USE_FOR_MILLIS == 0
+  #define PROFILE_OCR         OCR0B
+#else
+  #define PROFILE_OCR         OCR1B
+#endif
+
+#if defined( SPH )
+  #define PROFILE_LOAD_SPH    "in    r29, __SP_H__"   "\n\t"
+#else
+  #define PROFILE_LOAD_SPH    "clr   r29"             "\n\t"
+#endif
+
+// All addresses here are in words, the way the program counter counts
+static volatile uint16_t      profile_pc;
+static uint16_t               profile_first;
+static uint16_t               profile_span;
+static uint8_t                profile_shift;
+static uint8_t                profile_running;
+static uint16_t               profile_count[PROFILE_BUCKETS];
+static uint16_t               profile_outside;
+
+
+void profileBegin( uint16_t first, uint16_t last )
+{
+  uint8_t i;
+
+  profileEnd();
+
+  profile_first = first >> 1;
+  profile_span = (last >> 1) - profile_first;
+
+  profile_shift = 0;
+  while ( (profile_span >> profile_shift) >= PROFILE_BUCKETS )
+    ++profile_shift;
+
+  for ( i = 0; i < PROFILE_BUCKETS; ++i )
+    profile_count[i] = 0;
+  profile_outside = 0;
+
+  // Zero puts the sample right after the millis interrupt and that's all
+  // it would ever see.  Anything else was set by analogWrite; leave it.
+  if ( PROFILE_OCR == 0 )
+    PROFILE_OCR = 128;
+
+  profileResume();
+}
+
+uint8_t profileEnd( void )
+{
+  uint8_t rv;
+  uint8_t oldSREG;
+
+  oldSREG = SREG;
+  cli();
+  MillisTimer_(DisableOutputCompareInterruptB)();
+  rv = profile_running;
+  profile_running = 0;
+  SREG = oldSREG;
+
+  return( rv );
+}
+
+void profileResume( void )
+{
+  uint8_t oldSREG;
+
+  oldSREG = SREG;
+  cli();
+  profile_running = 1;
+  MillisTimer_(EnableOutputCompareInterruptB)();
+  SREG = oldSREG;
+}
+
+void profileReport( Print& out )
+{
+  uint8_t running;
+  uint8_t i;
+
+  // Not sampling the report itself keeps it out of the numbers and the
+  // counts still while they are read
+  running = profileEnd();
+
+  out.printf( F("#profile first=0x%04x step=%u buckets=%u outside=%u\r\n"),
+      profile_first << 1, 2 << profile_shift, PROFILE_BUCKETS, profile_outside );
+
+  for ( i = 0; i < PROFILE_BUCKETS; ++i )
+  {
+    if ( profile_count[i] )
+    {
+      out.printf( F("0x%04x %u\r\n"),
+          (profile_first + ((uint16_t) i << profile_shift)) << 1, profile_count[i] );
+    }
+  }
+
+  out.printf( F("#end\r\n") );
+
+  if ( running )
+    profileResume();
+}
+
+
+/*=============================================================================
+  The vector is a naked stub that copies the return address out of the
+  stack (high byte first, just above the three registers it saves) and
+  jumps to an ordinary interrupt handler for the counting.  The handler
+  is named like a vector so the compiler accepts it as one, and turns
+  interrupts back on first thing (like the millis interrupt) so USB is
+  only held off for the stub and the handler's first instruction.
+=============================================================================*/
+
+extern "C" void __vector_profile_sample( void ) ISR_NOBLOCK __attribute__((used));
+
+ISR( MILLISTIMER_(COMPB_vect), ISR_NAKED )
+{
+  asm volatile
+  (
+    "push  r0"                                "\n\t"
+    "push  r28"                               "\n\t"
+    "push  r29"                               "\n\t"
+    "in    r28, __SP_L__"                     "\n\t"
+    PROFILE_LOAD_SPH
+    "ldd   r0, Y+4"                           "\n\t"
+    "sts   %[pc]+1, r0"                       "\n\t"
+    "ldd   r0, Y+5"                           "\n\t"
+    "sts   %[pc], r0"                         "\n\t"
+    "pop   r29"                               "\n\t"
+    "pop   r28"                               "\n\t"
+    "pop   r0"                                "\n\t"
+    "rjmp  __vector_profile_sample"           "\n\t"
+    :
+    :
+      [pc] "i" ( &profile_pc )
+  );
+}
+
+void __vector_profile_sample( void )
+{
+  uint16_t offset;
+  uint16_t* bucket;
+  uint8_t i;
+
+  offset = profile_pc - profile_first;
+
+  if ( offset > profile_span )
+  {
+    bucket = &profile_outside;
+  }
+  else
+  {
+    for ( i = profile_shift; i; --i )
+      offset >>= 1;
+    bucket = &profile_count[offset];
+  }
+
+  if ( *bucket == 0xFFFF )
+  {
+    for ( i = 0; i < PROFILE_BUCKETS; ++i )
+      profile_count[i] >>= 1;
+    profile_outside >>= 1;
+  }
+
+  ++*bucket;
+}
@@ -25,45 +25,56 @@
 #include "wiring_private.h"
 #include "pins_arduino.h"
 
+/* The width has to convert without overflowing well past the 67108 ticks
+ * (about 260 ms at 16.5 MHz) where the old multiply-by-1000 conversion
+ * wrapped.  Checked at the 100 second limit documented below. */
+#define PULSE_MAX_TICKS ( (F_CPU / clockCyclesPerTick()) * 100 )
+typedef char pulse_width_has_to_convert_without_overflow
+    [ (ticksToMicroseconds( 67109UL ) > ticksToMicroseconds( 67108UL ))
+      && (ticksToMicroseconds( (unsigned long) PULSE_MAX_TICKS ) / 1000000UL >= 99) ? 1 : -1 ];
+
 /* Measures the length (in microseconds) of a pulse on the pin; state is HIGH
- * or LOW, the type of pulse to measure.  Works on pulses from 2-3 microseconds
- * to 3 minutes in length, but must be called at least a few dozen microseconds
- * before the start of the pulse. */
+ * or LOW, the type of pulse to measure.  Works on pulses from about 4
+ * microseconds up to the timeout (100 seconds at most) in length, but must be
+ * called before the start of the pulse.
+ *
+ * The edges are timestamped with the millis timer (one tick every 64 cycles)
+ * instead of counting trips round a loop, so an interrupt during the pulse
+ * (V-USB, millis) no longer shortens the reading.  An interrupt right on an
+ * edge still delays when that edge is seen.  For pulses on several pins at
+ * once without blocking see pulseStart() in wiring_pulse_async.c. */
 unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout)
 {
 	// cache the port and bit of the pin in order to speed up the
-	// pulse width measuring loop and achieve finer resolution.  calling
-	// digitalRead() instead yields much coarser resolution.
+	// polling loops and see the edges as soon as possible.
 	uint8_t bit = digitalPinToBitMask(pin);
-	uint8_t port = digitalPinToPort(pin);
+	volatile uint8_t *in = portInputRegister(digitalPinToPort(pin));
 	uint8_t stateMask = (state ? bit : 0);
-	unsigned long width = 0; // keep initialization out of time critical area
-	
-	// convert the timeout from microseconds to a number of times through
-	// the initial loop; it takes 16 clock cycles per iteration.
-	unsigned long numloops = 0;
-	unsigned long maxloops = microsecondsToClockCycles(timeout) / 16;
-	
+	unsigned long start = ticks();
+	// the timeout in ticks; dividing by the tick length first keeps it in 32 bits
+	unsigned long limit = ((timeout / clockCyclesPerTick()) * (F_CPU / 100000L)) / 10;
+	unsigned long edge;
+	uint8_t polls = 0;
+
+	// the timeout is only checked every 256 polls so the loops stay short
+#define PULSE_TIMED_OUT() ((++polls == 0) && ((ticks() - start) >= limit))
+
 	// wait for any previous pulse to end
-	while ((*portInputRegister(port) & bit) == stateMask)
-		if (numloops++ == maxloops)
+	while ((*in & bit) == stateMask)
+		if (PULSE_TIMED_OUT())
 			return 0;
-	
+
 	// wait for the pulse to start
-	while ((*portInputRegister(port) & bit) != stateMask)
-		if (numloops++ == maxloops)
+	while ((*in & bit) != stateMask)
+		if (PULSE_TIMED_OUT())
 			return 0;
-	
+
+	edge = ticks();
+
 	// wait for the pulse to stop
-	while ((*portInputRegister(port) & bit) == stateMask) {
-		if (numloops++ == maxloops)
+	while ((*in & bit) == stateMask)
+		if (PULSE_TIMED_OUT())
 			return 0;
-		width++;
-	}
 
-	// convert the reading to microseconds. The loop has been determined
-	// to be 20 clock cycles long and have about 16 clocks between the edge
-	// and the start of the loop. There will be some error introduced by
-	// the interrupt handlers.
-	return clockCyclesToMicroseconds(width * 21 + 16); 
+	return ticksToMicroseconds(ticks() - edge);
 }
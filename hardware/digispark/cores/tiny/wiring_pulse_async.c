@@ -0,0 +1,257 @@
+/*==============================================================================
+
+  wiring_pulse_async.c - Background pulse measurement on several pins.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+
+#include "wiring_private.h"
+#include "pins_arduino.h"
+
+#if defined( __AVR_ATtinyX5__ ) || defined( __AVR_ATtinyX4__ )
+
+
+/*=============================================================================
+  Each edge on a watched pin raises a pin change interrupt which stamps it
+  with ticks16() (the millis timer, one tick every 64 cycles).  When a pulse
+  of the requested level ends its width is stored for the channel and the
+  callback, if any, is called from the interrupt.
+
+  The edges come through the pin change router (wiring_pin_change.c) in
+  the INTERRUPT_SLOT_PULSE slot, so TinyPinChange and SoftwareSerial can
+  be used at the same time.  V-USB still owns the vector on the Digispark.
+  Nothing here is linked unless pulseStart is called.
+
+  Widths are good up to 65535 ticks (254 ms at 16.5 MHz).  A pulse shorter
+  than the interrupt latency (a few microseconds, more while another
+  interrupt is running) is missed.
+=============================================================================*/
+
+#if ! defined( PULSE_CHANNELS )
+  #define PULSE_CHANNELS  4
+#endif
+
+typedef struct
+{
+  uint8_t             pin;        // 0xFF when the channel is free
+  uint8_t             port;
+  uint8_t             mask;
+  uint8_t             stateMask;
+  uint8_t             armed;
+  volatile uint8_t    available;
+  uint16_t            start;
+  volatile uint16_t   width;
+}
+pulse_channel_t;
+
+static pulse_channel_t            pulse_channel[PULSE_CHANNELS] =
+{
+  #if PULSE_CHANNELS >= 1
+    { 0xFF },
+  #endif
+  #if PULSE_CHANNELS >= 2
+    { 0xFF },
+  #endif
+  #if PULSE_CHANNELS >= 3
+    { 0xFF },
+  #endif
+  #if PULSE_CHANNELS >= 4
+    { 0xFF },
+  #endif
+  #if PULSE_CHANNELS >= 5
+    #error Add initializers for the extra channels.
+  #endif
+};
+
+static pulseCallback_t volatile   pulse_callback;
+
+#if defined( __AVR_ATtinyX4__ )
+  static uint8_t                  pulse_previous[2];
+#else
+  static uint8_t                  pulse_previous[1];
+#endif
+
+
+static pulse_channel_t* pulseFind( uint8_t pin )
+{
+  uint8_t i;
+
+  for ( i = 0; i < PULSE_CHANNELS; ++i )
+  {
+    if ( pulse_channel[i].pin == pin )
+      return( &pulse_channel[i] );
+  }
+  return( 0 );
+}
+
+// index into pulse_previous for the pin's pin change group
+static uint8_t pulsePortIndex( uint8_t pin )
+{
+  #if defined( __AVR_ATtinyX4__ )
+    return( digitalPinToPCICRbit( pin ) == PCIE1 ? 1 : 0 );
+  #else
+    return( 0 );
+  #endif
+}
+
+uint8_t pulseStart( uint8_t pin, uint8_t state )
+{
+  pulse_channel_t* c;
+  uint8_t oldSREG;
+
+  if ( digitalPinToPCICR( pin ) == 0 )
+    return( 0 );
+
+  pulseStop( pin );
+
+  c = pulseFind( 0xFF );
+  if ( c == 0 )
+    return( 0 );
+
+  oldSREG = SREG;
+  cli();
+
+  c->port = pulsePortIndex( pin );
+  c->mask = digitalPinToBitMask( pin );
+  c->stateMask = state ? c->mask : 0;
+  c->armed = 0;
+  c->available = 0;
+  c->pin = pin;
+
+  pulse_previous[c->port] = *portInputRegister( digitalPinToPort( pin ) );
+  *digitalPinToPCMSK( pin ) |= _BV( digitalPinToPCMSKbit( pin ) );
+  *digitalPinToPCICR( pin ) |= _BV( digitalPinToPCICRbit( pin ) );
+
+  SREG = oldSREG;
+  return( 1 );
+}
+
+void pulseStop( uint8_t pin )
+{
+  pulse_channel_t* c;
+  uint8_t oldSREG;
+
+  c = pulseFind( pin );
+  if ( c == 0 )
+    return;
+
+  oldSREG = SREG;
+  cli();
+  *digitalPinToPCMSK( pin ) &= ~_BV( digitalPinToPCMSKbit( pin ) );
+  c->pin = 0xFF;
+  SREG = oldSREG;
+}
+
+uint8_t pulseAvailable( uint8_t pin )
+{
+  pulse_channel_t* c = pulseFind( pin );
+  return( c ? c->available : 0 );
+}
+
+uint16_t pulseReadTicks( uint8_t pin )
+{
+  pulse_channel_t* c;
+  uint8_t oldSREG;
+  uint16_t rv;
+
+  c = pulseFind( pin );
+  if ( c == 0 )
+    return( 0 );
+
+  oldSREG = SREG;
+  cli();
+  rv = c->width;
+  c->available = 0;
+  SREG = oldSREG;
+
+  return( rv );
+}
+
+unsigned long pulseRead( uint8_t pin )
+{
+  return( ticksToMicroseconds( (unsigned long) pulseReadTicks( pin ) ) );
+}
+
+void pulseOnComplete( pulseCallback_t callback )
+{
+  pulse_callback = callback;
+}
+
+
+/*=============================================================================
+  Pin change interrupt(s)
+=============================================================================*/
+
+static void pulseService( uint8_t port, uint8_t now_pins, uint16_t now )
+{
+  pulse_channel_t* c;
+  pulseCallback_t callback;
+  uint8_t changed;
+  uint16_t width;
+
+  changed = now_pins ^ pulse_previous[port];
+  pulse_previous[port] = now_pins;
+
+  for ( c = pulse_channel; c < pulse_channel + PULSE_CHANNELS; ++c )
+  {
+    if ( (c->pin == 0xFF) || (c->port != port) || ! (changed & c->mask) )
+      continue;
+
+    if ( (now_pins & c->mask) == c->stateMask )
+    {
+      c->start = now;
+      c->armed = 1;
+    }
+    else if ( c->armed )
+    {
+      width = now - c->start;
+      c->width = width;
+      c->available = 1;
+      c->armed = 0;
+
+      callback = pulse_callback;
+      if ( callback )
+        callback( c->pin, width );
+    }
+  }
+}
+
+#if defined( __AVR_ATtinyX4__ )
+
+PCINT0_HANDLER( INTERRUPT_SLOT_PULSE, 0xFF )
+{
+  pulseService( 0, now, ticks16() );
+}
+
+PCINT1_HANDLER( INTERRUPT_SLOT_PULSE, 0xFF )
+{
+  pulseService( 1, now, ticks16() );
+}
+
+#else
+
+PCINT0_HANDLER( INTERRUPT_SLOT_PULSE, 0xFF )
+{
+  pulseService( 0, now, ticks16() );
+}
+
+#endif
+
+
+#endif
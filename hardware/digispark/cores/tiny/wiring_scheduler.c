@@ -0,0 +1,222 @@
+/*==============================================================================
+
+  wiring_scheduler.c - Software timers ticked by the millis timer.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+
+#include "wiring_private.h"
+
+
+/*=============================================================================
+  The timers hang off a small hashed wheel, one slot per millisecond modulo
+  SCHEDULER_SLOTS.  The millis timer interrupt only records the time;
+  schedulerRun (called by main after every loop, or by the sketch) looks at
+  the slots for the milliseconds that have gone by since it last ran, moves
+  the timers that are due onto the ready list and calls them.  A timer
+  further than SCHEDULER_SLOTS ms away just stays in its slot until its
+  millisecond comes round.  Nothing here runs with interrupts off (USB has
+  to get in at any time) and nothing walks a list from an interrupt, so
+  the timers can only be started and stopped from the sketch or from a
+  callback, never from an interrupt handler.
+
+  The caller owns the schedulerTimer_t; nothing is allocated.  It has to
+  start out zeroed (globals and statics are).  Delays and periods are in
+  milliseconds, up to 32767.
+=============================================================================*/
+
+#define SCHEDULER_SLOTS       8
+
+#define SCHEDULER_IDLE        0
+#define SCHEDULER_WAITING     1
+#define SCHEDULER_READY       2
+
+extern void (* volatile millis_timer_hook)( unsigned long m );
+
+static schedulerTimer_t*  scheduler_wheel[SCHEDULER_SLOTS];
+static schedulerTimer_t*  scheduler_ready;
+static schedulerTimer_t** scheduler_ready_tail = &scheduler_ready;
+static volatile uint16_t  scheduler_tick;     // millis, from the interrupt
+static uint16_t           scheduler_now;      // how far schedulerRun has got
+static uint8_t            scheduler_started;
+
+
+static void schedulerUnlink( schedulerTimer_t** head, schedulerTimer_t* timer )
+{
+  while ( *head )
+  {
+    if ( *head == timer )
+    {
+      *head = timer->next;
+      return;
+    }
+    head = &(*head)->next;
+  }
+}
+
+static void schedulerInsert( schedulerTimer_t* timer )
+{
+  schedulerTimer_t** slot = &scheduler_wheel[timer->expires & (SCHEDULER_SLOTS - 1)];
+
+  timer->next = *slot;
+  *slot = timer;
+  timer->state = SCHEDULER_WAITING;
+}
+
+static void schedulerTick( unsigned long m )
+{
+  scheduler_tick = (uint16_t) m;
+}
+
+static uint16_t schedulerNow( void )
+{
+  uint16_t now;
+  uint8_t oldSREG;
+
+  oldSREG = SREG;
+  cli();
+  now = scheduler_tick;
+  SREG = oldSREG;
+
+  return( now );
+}
+
+// Moves the timers due by now from the slots of the milliseconds since
+// the last pass onto the ready list
+static void schedulerExpire( uint16_t now )
+{
+  schedulerTimer_t** link;
+  schedulerTimer_t* timer;
+  uint16_t gone;
+
+  // A slot only has to be looked at once however far behind we are
+  gone = now - scheduler_now;
+  if ( gone > SCHEDULER_SLOTS )
+    gone = SCHEDULER_SLOTS;
+
+  while ( gone-- )
+  {
+    link = &scheduler_wheel[(now - gone) & (SCHEDULER_SLOTS - 1)];
+
+    while ( (timer = *link) != 0 )
+    {
+      if ( (int16_t)(timer->expires - now) <= 0 )
+      {
+        *link = timer->next;
+        timer->next = 0;
+        timer->state = SCHEDULER_READY;
+        *scheduler_ready_tail = timer;
+        scheduler_ready_tail = &timer->next;
+      }
+      else
+      {
+        link = &timer->next;
+      }
+    }
+  }
+
+  scheduler_now = now;
+}
+
+
+void schedulerStart( schedulerTimer_t* timer, schedulerCallback_t callback, void* arg, uint16_t delay, uint16_t period )
+{
+  uint8_t oldSREG;
+
+  schedulerStop( timer );
+
+  timer->callback = callback;
+  timer->arg = arg;
+  timer->period = period;
+
+  if ( ! scheduler_started )
+  {
+    oldSREG = SREG;
+    cli();
+    scheduler_tick = (uint16_t) millis();
+    millis_timer_hook = schedulerTick;
+    SREG = oldSREG;
+    scheduler_now = scheduler_tick;
+    scheduler_started = 1;
+  }
+
+  // A delay of zero runs at the next millisecond.
+  timer->expires = schedulerNow() + (delay ? delay : 1);
+  schedulerInsert( timer );
+}
+
+void schedulerStop( schedulerTimer_t* timer )
+{
+  if ( timer->state == SCHEDULER_WAITING )
+  {
+    schedulerUnlink( &scheduler_wheel[timer->expires & (SCHEDULER_SLOTS - 1)], timer );
+  }
+  else if ( timer->state == SCHEDULER_READY )
+  {
+    schedulerUnlink( &scheduler_ready, timer );
+
+    // fix the tail if the last one was removed
+    scheduler_ready_tail = &scheduler_ready;
+    while ( *scheduler_ready_tail )
+      scheduler_ready_tail = &(*scheduler_ready_tail)->next;
+  }
+  timer->state = SCHEDULER_IDLE;
+}
+
+uint8_t schedulerPending( schedulerTimer_t* timer )
+{
+  return( timer->state != SCHEDULER_IDLE );
+}
+
+uint8_t schedulerRun( void )
+{
+  schedulerTimer_t* timer;
+  uint8_t count = 0;
+
+  if ( ! scheduler_started )
+    return( 0 );
+
+  schedulerExpire( schedulerNow() );
+
+  while ( (timer = scheduler_ready) != 0 )
+  {
+    scheduler_ready = timer->next;
+    if ( scheduler_ready == 0 )
+      scheduler_ready_tail = &scheduler_ready;
+
+    // Periodic timers are rescheduled from when they were due, not from
+    // now, so they don't drift when the loop is slow.
+    if ( timer->period )
+    {
+      timer->expires += timer->period;
+      if ( (int16_t)(timer->expires - scheduler_now) <= 0 )
+        timer->expires = scheduler_now + 1;
+      schedulerInsert( timer );
+    }
+    else
+    {
+      timer->state = SCHEDULER_IDLE;
+    }
+
+    timer->callback( timer->arg );
+    ++count;
+  }
+
+  return( count );
+}
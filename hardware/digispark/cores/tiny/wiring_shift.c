@@ -1,5 +1,5 @@
 /*
-  wiring_shift.c - shiftOut() function
+  wiring_shift.c - shiftOut(), shiftIn(), and the USI SPI master
   Part of Arduino - http://www.arduino.cc/
 
   Copyright (c) 2005-2006 David A. Mellis
@@ -23,11 +23,75 @@
 */
 
 #include "wiring_private.h"
+#include "core_usi.h"
+
+#if defined( CORE_USI_DO_PIN )
+
+/*
+  When the data and clock pins are the USI pins the byte is shifted by the
+  USI (see core_usi.h) instead of three digital calls per bit.  The pin
+  levels before and after match the bit-banged version: the clock is left
+  low and the data pin holds the last bit.  Like the bit-banged version the
+  pins have to be set as outputs by the caller.
+*/
+
+static uint8_t reverseBits(uint8_t b)
+{
+	b = (b >> 4) | (b << 4);
+	b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+	b = ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+	return b;
+}
+
+void usiBegin(void)
+{
+	pinMode(CORE_USI_DO_PIN, OUTPUT);
+	pinMode(CORE_USI_SCK_PIN, OUTPUT);
+	pinMode(CORE_USI_DI_PIN, INPUT);
+	digitalWrite(CORE_USI_SCK_PIN, LOW);
+	USI_EnableThreeWire();
+}
+
+void usiEnd(void)
+{
+	USI_Disable();
+}
+
+uint8_t usiTransfer(uint8_t data)
+{
+	return USI_Transfer(data);
+}
+
+void usiTransferBuffer(void *buf, size_t count)
+{
+	uint8_t *p = (uint8_t *)buf;
+
+	while (count--) {
+		*p = USI_Transfer(*p);
+		++p;
+	}
+}
+
+#endif
 
 uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {
 	uint8_t value = 0;
 	uint8_t i;
 
+#if defined( CORE_USI_DO_PIN )
+	// DO is driven from USIDR while the USI is on so only use it when DO
+	// isn't an output
+	if ((dataPin == CORE_USI_DI_PIN) && (clockPin == CORE_USI_SCK_PIN)
+			&& !(*CORE_PIN_TO_DDR(CORE_USI_DO_PIN) & _BV(CORE_PIN_TO_BIT(CORE_USI_DO_PIN)))) {
+		turnOffPWM(CORE_USI_SCK_PIN);
+		digitalWrite(CORE_USI_SCK_PIN, LOW);
+		USI_EnableThreeWire();
+		value = USI_Transfer(0);
+		USI_Disable();
+		return (bitOrder == LSBFIRST) ? reverseBits(value) : value;
+	}
+#endif
+
 	for (i = 0; i < 8; ++i) {
 		digitalWrite(clockPin, HIGH);
 		if (bitOrder == LSBFIRST)
@@ -43,6 +107,21 @@ void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val)
 {
 	uint8_t i;
 
+#if defined( CORE_USI_DO_PIN )
+	if ((dataPin == CORE_USI_DO_PIN) && (clockPin == CORE_USI_SCK_PIN)) {
+		if (bitOrder == LSBFIRST)
+			val = reverseBits(val);
+		turnOffPWM(CORE_USI_DO_PIN);
+		turnOffPWM(CORE_USI_SCK_PIN);
+		digitalWrite(CORE_USI_SCK_PIN, LOW);
+		USI_EnableThreeWire();
+		USI_Transfer(val);
+		digitalWrite(CORE_USI_DO_PIN, val & 1);
+		USI_Disable();
+		return;
+	}
+#endif
+
 	for (i = 0; i < 8; i++)  {
 		if (bitOrder == LSBFIRST)
 			digitalWrite(dataPin, !!(val & (1 << i)));
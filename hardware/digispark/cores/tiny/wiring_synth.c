@@ -0,0 +1,227 @@
+/*==============================================================================
+
+  wiring_synth.c - Several tones at once mixed on the user timer's PWM output.
+
+  This file is part of Arduino-Tiny.
+
+  Arduino-Tiny is free software: you can redistribute it and/or modify it
+  under the terms of the GNU Lesser General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or (at your
+  option) any later version.
+
+  Arduino-Tiny is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+  License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+
+==============================================================================*/
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "wiring_private.h"
+#include "UserTimer.h"
+
+
+/*=============================================================================
+  Direct digital synthesis.  The user timer runs 8 bit fast PWM with no
+  prescaler (a 64 kHz carrier at 16.5 MHz, well above hearing; an RC filter
+  or the speaker itself smooths it out).  Every SYNTH_OVERFLOWS_PER_SAMPLE
+  overflows the interrupt adds each voice's increment to its 16 bit phase,
+  looks up the top 8 bits in the voice's waveform, and writes the mix to the
+  output compare register.  A voice without a waveform is a sawtooth (the
+  phase itself) which costs no table read.
+
+  The user timer is the one tone() and analogWrite on its two PWM pins use.
+  synthBegin takes it over and synthEnd puts it back the way init left it;
+  don't use those in between.  The output has to be one of the timer's
+  output compare pins.
+
+  The interrupt runs with interrupts enabled so V-USB (and millis) are
+  delayed by a few cycles at most.  A sample that comes due while the
+  previous one is still being worked out is skipped.
+=============================================================================*/
+
+#if SYNTH_VOICES >= 3
+  #define SYNTH_MIX_SHIFT  2
+#elif SYNTH_VOICES == 2
+  #define SYNTH_MIX_SHIFT  1
+#else
+  #define SYNTH_MIX_SHIFT  0
+#endif
+
+#if SYNTH_VOICES > 4
+  #error The mix can only hold four voices.  Increase SYNTH_MIX_SHIFT.
+#endif
+
+typedef struct
+{
+  const int8_t*       wave;       // in flash; 0 for a sawtooth
+  uint16_t            phase;
+  uint16_t            increment;
+  uint8_t             attenuation;
+}
+synth_voice_t;
+
+static synth_voice_t      synth_voice[SYNTH_VOICES];
+static uint8_t            synth_countdown;
+static volatile uint8_t   synth_busy;
+static uint8_t            synth_channel;
+static uint8_t            synth_pin = 0xFF;
+
+const int8_t synthSine[256] PROGMEM =
+{
+     0,    3,    6,    9,   12,   16,   19,   22,   25,   28,   31,   34,   37,   40,   43,   46,
+    49,   51,   54,   57,   60,   63,   65,   68,   71,   73,   76,   78,   81,   83,   85,   88,
+    90,   92,   94,   96,   98,  100,  102,  104,  106,  107,  109,  111,  112,  113,  115,  116,
+   117,  118,  120,  121,  122,  122,  123,  124,  125,  125,  126,  126,  126,  127,  127,  127,
+   127,  127,  127,  127,  126,  126,  126,  125,  125,  124,  123,  122,  122,  121,  120,  118,
+   117,  116,  115,  113,  112,  111,  109,  107,  106,  104,  102,  100,   98,   96,   94,   92,
+    90,   88,   85,   83,   81,   78,   76,   73,   71,   68,   65,   63,   60,   57,   54,   51,
+    49,   46,   43,   40,   37,   34,   31,   28,   25,   22,   19,   16,   12,    9,    6,    3,
+     0,   -3,   -6,   -9,  -12,  -16,  -19,  -22,  -25,  -28,  -31,  -34,  -37,  -40,  -43,  -46,
+   -49,  -51,  -54,  -57,  -60,  -63,  -65,  -68,  -71,  -73,  -76,  -78,  -81,  -83,  -85,  -88,
+   -90,  -92,  -94,  -96,  -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+  -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+  -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+  -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100,  -98,  -96,  -94,  -92,
+   -90,  -88,  -85,  -83,  -81,  -78,  -76,  -73,  -71,  -68,  -65,  -63,  -60,  -57,  -54,  -51,
+   -49,  -46,  -43,  -40,  -37,  -34,  -31,  -28,  -25,  -22,  -19,  -16,  -12,   -9,   -6,   -3
+};
+
+
+uint8_t synthBegin( uint8_t pin )
+{
+  uint8_t i;
+
+  if ( (pin != UserTimer_OutputComparePinA) && (pin != UserTimer_OutputComparePinB) )
+    return( 0 );
+
+  synthEnd();
+
+  for ( i = 0; i < SYNTH_VOICES; ++i )
+  {
+    synth_voice[i].wave = synthSine;
+    synth_voice[i].phase = 0;
+    synth_voice[i].increment = 0;
+    synth_voice[i].attenuation = 0;
+  }
+  synth_countdown = 1;
+  synth_busy = 0;
+
+  UserTimer_SetToPowerup();
+  UserTimer_SetWaveformGenerationMode( UserTimer_(Fast_PWM_FF) );
+
+  // Start at the middle of the range; that is silence
+  if ( pin == UserTimer_OutputComparePinA )
+  {
+    synth_channel = 0;
+    UserTimer_SetOutputCompareMatchA( 128 );
+    UserTimer_SetCompareOutputModeA( UserTimer_(Clear) );
+  }
+  else
+  {
+    synth_channel = 1;
+    UserTimer_SetOutputCompareMatchB( 128 );
+    UserTimer_SetCompareOutputModeB( UserTimer_(Clear) );
+  }
+
+  pinMode( pin, OUTPUT );
+  synth_pin = pin;
+
+  UserTimer_EnableOverflowInterrupt();
+  UserTimer_ClockSelect( UserTimer_(Prescale_Index_1) );
+
+  return( 1 );
+}
+
+void synthEnd( void )
+{
+  if ( synth_pin == 0xFF )
+    return;
+
+  UserTimer_InterruptsOff();
+  initToneTimer();
+  digitalWrite( synth_pin, LOW );
+
+  synth_pin = 0xFF;
+}
+
+void synthSetVoice( uint8_t voice, const int8_t* wave, uint8_t attenuation )
+{
+  uint8_t oldSREG;
+
+  if ( voice >= SYNTH_VOICES )
+    return;
+
+  oldSREG = SREG;
+  cli();
+  synth_voice[voice].wave = wave;
+  synth_voice[voice].attenuation = attenuation;
+  SREG = oldSREG;
+}
+
+void synthSetIncrement( uint8_t voice, uint16_t increment )
+{
+  uint8_t oldSREG;
+
+  if ( voice >= SYNTH_VOICES )
+    return;
+
+  oldSREG = SREG;
+  cli();
+  synth_voice[voice].increment = increment;
+
+  // A stopped voice goes back to the start of its waveform (zero for the
+  // sine and the sawtooth) so it doesn't leave an offset in the mix.
+  if ( increment == 0 )
+    synth_voice[voice].phase = 0;
+  SREG = oldSREG;
+}
+
+
+/*=============================================================================
+  User timer overflow
+=============================================================================*/
+
+ISR( USERTIMER_OVF_vect, ISR_NOBLOCK )
+{
+  synth_voice_t* v;
+  int16_t mix;
+  int8_t sample;
+  uint8_t out;
+
+  if ( --synth_countdown != 0 )
+    return;
+  synth_countdown = SYNTH_OVERFLOWS_PER_SAMPLE;
+
+  if ( synth_busy )
+    return;
+  synth_busy = 1;
+
+  mix = 0;
+
+  for ( v = synth_voice; v < synth_voice + SYNTH_VOICES; ++v )
+  {
+    v->phase += v->increment;
+
+    if ( v->wave )
+      sample = pgm_read_byte( v->wave + (uint8_t)(v->phase >> 8) );
+    else
+      sample = (int8_t)(v->phase >> 8);
+
+    mix += sample >> v->attenuation;
+  }
+
+  out = (uint8_t)(128 + (mix >> SYNTH_MIX_SHIFT));
+
+  if ( synth_channel == 0 )
+    UserTimer_SetOutputCompareMatchA( out );
+  else
+    UserTimer_SetOutputCompareMatchB( out );
+
+  synth_busy = 0;
+}
@@ -0,0 +1,192 @@
+#!/usr/bin/env python
+#
+# digiusb_stream.py - Read what a DigiUSB sketch prints, on Linux.
+#
+# This file is part of Arduino-Tiny.
+#
+# Arduino-Tiny is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# Arduino-Tiny is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+#
+# usage: digiusb_stream.py [--stats] [--control]
+#
+# Needs pyusb (pip install pyusb) and permission to open the device (run
+# as root or add a udev rule for 16c0:05df).
+#
+# With firmware that has it (DIGIUSB_PROTOCOL_VERSION 2) the interrupt-IN
+# stream is turned on and read; the device sends whenever it has data and
+# nothing here polls.  Older firmware, or --control, is read with control
+# transfers: chunked ones for version 1, a byte at a time before that.
+#
+# --stats writes a line to stderr every second with the bytes per second
+# and the time between packets (the interval the host actually polls at,
+# which bounds the latency of a byte that is ready).
+
+import sys
+import time
+
+import usb.core
+import usb.util
+
+VENDOR_ID = 0x16c0
+PRODUCT_ID = 0x05df
+
+# from DigiUSB.h
+RQ_INFO = 0x01
+RQ_STREAM = 0x02
+
+HID_GET_REPORT = 0x01
+
+TYPE_VENDOR_IN = 0xC0
+TYPE_VENDOR_OUT = 0x40
+TYPE_CLASS_IN = 0xA0
+
+ENDPOINT_IN = 0x81
+
+
+def open_device():
+    dev = usb.core.find(idVendor=VENDOR_ID, idProduct=PRODUCT_ID)
+    if dev is None:
+        raise IOError('no DigiUSB device found')
+    try:
+        if dev.is_kernel_driver_active(0):
+            dev.detach_kernel_driver(0)
+    except (NotImplementedError, usb.core.USBError):
+        pass
+    dev.set_configuration()
+    usb.util.claim_interface(dev, 0)
+    return dev
+
+
+def protocol_version(dev):
+    """0 for firmware that doesn't answer DIGIUSB_RQ_INFO."""
+    try:
+        info = dev.ctrl_transfer(TYPE_VENDOR_IN, RQ_INFO, 0, 0, 4, 1000)
+    except usb.core.USBError:
+        return 0
+    if len(info) < 1:
+        return 0
+    return info[0]
+
+
+class Reader(object):
+    """Returns the bytes the device sends, one packet or transfer at a
+    time, and keeps the numbers for --stats."""
+
+    def __init__(self, dev, version, control=False):
+        self.dev = dev
+        self.version = version
+        self.stream = (version >= 2) and not control
+        self.bytes = 0
+        self.packets = 0
+        self.gaps = []
+        self.last = None
+
+    def start(self):
+        if self.stream:
+            self.dev.ctrl_transfer(TYPE_VENDOR_OUT, RQ_STREAM, 1, 0, None, 1000)
+
+    def stop(self):
+        if self.stream:
+            try:
+                self.dev.ctrl_transfer(TYPE_VENDOR_OUT, RQ_STREAM, 0, 0, None, 1000)
+            except usb.core.USBError:
+                pass
+
+    def _read(self):
+        if self.stream:
+            try:
+                return bytes(bytearray(self.dev.read(ENDPOINT_IN, 8, 1000)))
+            except usb.core.USBError as e:
+                # a timeout just means the sketch had nothing to say
+                if e.errno == 110:
+                    return b''
+                raise
+
+        if self.version >= 1:
+            data = bytearray(self.dev.ctrl_transfer(TYPE_CLASS_IN, HID_GET_REPORT, 0, 0, 128, 1000))
+            if len(data) == 0:
+                return b''
+            return bytes(data[1:1 + data[0]])
+
+        try:
+            data = self.dev.ctrl_transfer(TYPE_CLASS_IN, HID_GET_REPORT, 0, 0, 1, 1000)
+        except usb.core.USBError:
+            # the old firmware stalls when it has nothing
+            data = []
+        return bytes(bytearray(data))
+
+    def read(self):
+        data = self._read()
+        now = time.time()
+
+        if data:
+            if self.last is not None:
+                self.gaps.append(now - self.last)
+            self.last = now
+            self.bytes += len(data)
+            self.packets += 1
+        elif not self.stream:
+            # don't spin on the control pipe
+            time.sleep(0.001)
+
+        return data
+
+    def stats(self, seconds):
+        gaps = sorted(self.gaps)
+        if gaps:
+            text = '%d bytes/s, %d packets, gap ms min %.1f median %.1f max %.1f' % (
+                self.bytes / seconds, self.packets,
+                gaps[0] * 1000, gaps[len(gaps) // 2] * 1000, gaps[-1] * 1000)
+        else:
+            text = '%d bytes/s, %d packets' % (self.bytes / seconds, self.packets)
+        self.bytes = 0
+        self.packets = 0
+        self.gaps = []
+        return text
+
+
+def main(argv):
+    stats = '--stats' in argv
+    control = '--control' in argv
+
+    dev = open_device()
+    version = protocol_version(dev)
+    reader = Reader(dev, version, control)
+
+    sys.stderr.write('DigiUSB protocol %d, reading %s\n' % (version,
+                     'the interrupt-IN stream' if reader.stream else 'with control transfers'))
+
+    out = getattr(sys.stdout, 'buffer', sys.stdout)
+    reader.start()
+    try:
+        mark = time.time()
+        while True:
+            data = reader.read()
+            if data:
+                out.write(data)
+                out.flush()
+            if stats and time.time() - mark >= 1.0:
+                now = time.time()
+                sys.stderr.write(reader.stats(now - mark) + '\n')
+                mark = now
+    except KeyboardInterrupt:
+        pass
+    finally:
+        reader.stop()
+        usb.util.release_interface(dev, 0)
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,214 @@
+#!/usr/bin/env python
+#
+# tinyprof.py - Turn profileReport output into time per function.
+#
+# This file is part of Arduino-Tiny.
+#
+# Arduino-Tiny is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# Arduino-Tiny is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+#
+# usage: tinyprof.py sketch.elf dump.txt [dump.txt ...]
+#
+# Each dump is whatever was captured from the device (a terminal log, the
+# output of DigiUSB's monitor, ...); anything outside the #profile / #end
+# lines is ignored and every histogram found is added up.  "-" reads the
+# dump from stdin.  The .elf is in the IDE's build folder (File >
+# Preferences, "Show verbose output during compilation" to find it).
+#
+# Only the ELF symbol table is used, so no AVR tools are needed.  The
+# output of "avr-nm -S sketch.elf" can be given instead of the .elf.  When a
+# histogram bucket covers more than one function its samples are split
+# between them by how many of the bucket's bytes each one has; profile a
+# narrower range (profileBegin(first, last)) for exact numbers.
+#
+# tinyprof_test/ has a recorded dump and symbol list with the numbers they
+# should give: python tinyprof_test/test_tinyprof.py
+
+import struct
+import sys
+
+
+def read_nm(text):
+    """Return [(address, size, name)] for the functions in nm -S output,
+    sorted by address."""
+    rv = []
+
+    for line in text.splitlines():
+        fields = line.split()
+        # address size type name; symbols without a size have three fields
+        if len(fields) != 4 or fields[2] not in ('T', 't', 'W', 'w'):
+            continue
+        size = int(fields[1], 16)
+        if size == 0:
+            continue
+        rv.append((int(fields[0], 16), size, fields[3]))
+
+    rv.sort()
+    return rv
+
+
+def read_functions(path):
+    """Return [(address, size, name)] for the functions in an ELF file (or
+    nm -S output), sorted by address."""
+    f = open(path, 'rb')
+    data = f.read()
+    f.close()
+
+    if data[:4] != b'\x7fELF':
+        return read_nm(data.decode('latin-1'))
+
+    is64 = data[4:5] == b'\x02'
+    endian = '<' if data[5:6] == b'\x01' else '>'
+
+    if is64:
+        shoff, = struct.unpack_from(endian + 'Q', data, 0x28)
+        shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x3A)
+        shdr = endian + 'IIQQQQIIQQ'
+    else:
+        shoff, = struct.unpack_from(endian + 'I', data, 0x20)
+        shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x2E)
+        shdr = endian + 'IIIIIIIIII'
+
+    sections = []
+    for i in range(shnum):
+        sections.append(struct.unpack_from(shdr, data, shoff + i * shentsize))
+
+    functions = {}
+    for sh in sections:
+        # sh_type 2 is SHT_SYMTAB
+        if sh[1] != 2:
+            continue
+        strtab = sections[sh[6]]
+        str_offset = strtab[4]
+        offset, size, entsize = sh[4], sh[5], sh[9]
+
+        for o in range(offset, offset + size, entsize):
+            if is64:
+                name, info, other, shndx, value, length = \
+                    struct.unpack_from(endian + 'IBBHQQ', data, o)
+            else:
+                name, value, length, info, other, shndx = \
+                    struct.unpack_from(endian + 'IIIBBH', data, o)
+
+            # STT_FUNC only; the vector table and the like have no size
+            if (info & 0x0F) != 2 or length == 0:
+                continue
+
+            end = data.index(b'\0', str_offset + name)
+            text = data[str_offset + name:end].decode('latin-1')
+            functions[(value, length)] = text
+
+    rv = [(a, n, functions[(a, n)]) for (a, n) in functions]
+    rv.sort()
+    return rv
+
+
+def read_dump(lines):
+    """Return (step, {address: count}, outside) added up over every
+    histogram in lines."""
+    step = None
+    counts = {}
+    outside = 0
+    inside = False
+
+    for line in lines:
+        line = line.strip()
+
+        if line.startswith('#profile'):
+            fields = dict(f.split('=', 1) for f in line.split()[1:])
+            this_step = int(fields['step'], 0)
+            if step is not None and this_step != step:
+                raise ValueError('dumps with different ranges can not be added')
+            step = this_step
+            outside += int(fields['outside'], 0)
+            inside = True
+        elif line.startswith('#end'):
+            inside = False
+        elif inside and line:
+            address, count = line.split()
+            address = int(address, 0)
+            counts[address] = counts.get(address, 0) + int(count, 0)
+
+    if step is None:
+        raise ValueError('no #profile found')
+
+    return step, counts, outside
+
+
+def attribute(functions, step, counts):
+    """Spread each bucket's count over the functions it overlaps.  Returns
+    {name: samples}; bytes that belong to no function are '(unknown)'."""
+    rv = {}
+
+    for start, count in counts.items():
+        end = start + step
+        covered = 0
+
+        for address, size, name in functions:
+            if address >= end:
+                break
+            overlap = min(end, address + size) - max(start, address)
+            if overlap <= 0:
+                continue
+            rv[name] = rv.get(name, 0.0) + float(count) * overlap / step
+            covered += overlap
+
+        if covered < step:
+            rv['(unknown)'] = rv.get('(unknown)', 0.0) + \
+                float(count) * (step - covered) / step
+
+    return rv
+
+
+def report(out, functions, step, counts, outside):
+    samples = attribute(functions, step, counts)
+    total = sum(counts.values()) + outside
+
+    if total == 0:
+        out.write('no samples\n')
+        return
+
+    out.write('%d samples, %d bytes per bucket%s\n\n' % (total, step,
+              '' if step <= 2 else ' (counts split between functions)'))
+
+    rows = sorted(samples.items(), key=lambda r: (-r[1], r[0]))
+    if outside:
+        rows.append(('(outside the range)', outside))
+
+    for name, count in rows:
+        out.write('%6.1f%% %9.1f  %s\n' % (100.0 * count / total, count, name))
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.stderr.write('usage: %s sketch.elf dump.txt [dump.txt ...]\n' % argv[0])
+        return 2
+
+    functions = read_functions(argv[1])
+
+    lines = []
+    for path in argv[2:]:
+        if path == '-':
+            lines.extend(sys.stdin.readlines())
+        else:
+            f = open(path)
+            lines.extend(f.readlines())
+            f.close()
+
+    step, counts, outside = read_dump(lines)
+    report(sys.stdout, functions, step, counts, outside)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+#
+# test_tinyprof.py - Checks tinyprof.py against a recorded dump.
+#
+# This file is part of Arduino-Tiny.
+#
+# Arduino-Tiny is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or (at your
+# option) any later version.
+#
+# Arduino-Tiny is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+# License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with Arduino-Tiny.  If not, see <http://www.gnu.org/licenses/>.
+#
+# usage: test_tinyprof.py
+#
+# sample_dump.txt is two profileReport histograms in a terminal log, taken
+# over the whole flash (256 bytes a bucket).  sample.sym is the avr-nm -S
+# listing they go with, trimmed to a few functions laid out so that:
+#
+#   0x0000  __vectors (0x68 bytes) and main (0x98) share the bucket
+#   0x0100  loop (0x80) and helper (0x40) with 0x40 bytes of no function
+#   0x0200  __vector_5 covers two whole buckets
+#
+# sample_report.txt is what tinyprof.py should print for them.
+
+import os
+import struct
+import sys
+import tempfile
+import unittest
+
+try:
+    from StringIO import StringIO
+except ImportError:
+    from io import StringIO
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.dirname(HERE))
+
+import tinyprof
+
+
+def fixture(name):
+    return os.path.join(HERE, name)
+
+
+def read_lines(name):
+    f = open(fixture(name))
+    lines = f.readlines()
+    f.close()
+    return lines
+
+
+def tiny_elf(symbols):
+    """A 32-bit little-endian ELF with only a symbol table, which is all
+    tinyprof reads.  symbols is [(name, address, size, type)]."""
+    strtab = b'\0'
+    symtab = struct.pack('<IIIBBH', 0, 0, 0, 0, 0, 0)
+    for name, address, size, kind in symbols:
+        symtab += struct.pack('<IIIBBH', len(strtab), address, size, 0x10 | kind, 0, 1)
+        strtab += name.encode('latin-1') + b'\0'
+
+    strtab_offset = 52
+    symtab_offset = strtab_offset + len(strtab)
+    shoff = symtab_offset + len(symtab)
+
+    header = b'\x7fELF\x01\x01\x01' + b'\0' * 9
+    header += struct.pack('<HHIIIIIHHHHHH', 1, 83, 1, 0, 0, shoff, 0, 52, 0, 0, 40, 3, 1)
+
+    sections = struct.pack('<IIIIIIIIII', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+    sections += struct.pack('<IIIIIIIIII', 0, 3, 0, 0, strtab_offset, len(strtab), 0, 0, 1, 0)
+    sections += struct.pack('<IIIIIIIIII', 0, 2, 0, 0, symtab_offset, len(symtab), 1, 1, 4, 16)
+
+    return header + strtab + symtab + sections
+
+
+class TinyprofTest(unittest.TestCase):
+
+    def test_symbol_list(self):
+        functions = tinyprof.read_functions(fixture('sample.sym'))
+        self.assertEqual(functions, [
+            (0x0000, 0x68, '__vectors'),
+            (0x0068, 0x98, 'main'),
+            (0x0100, 0x80, 'loop'),
+            (0x0180, 0x40, 'helper'),
+            (0x0200, 0x200, '__vector_5'),
+        ])
+
+    def test_elf(self):
+        # objects (type 1) and sizeless symbols are left out
+        data = tiny_elf([('loop', 0x100, 0x80, 2), ('main', 0x68, 0x98, 2),
+                         ('buffer', 0x800060, 16, 1), ('__bad_interrupt', 0x1c0, 0, 2)])
+        f = tempfile.NamedTemporaryFile(suffix='.elf', delete=False)
+        try:
+            f.write(data)
+            f.close()
+            functions = tinyprof.read_functions(f.name)
+        finally:
+            os.unlink(f.name)
+        self.assertEqual(functions, [(0x68, 0x98, 'main'), (0x100, 0x80, 'loop')])
+
+    def test_dumps_add_up(self):
+        step, counts, outside = tinyprof.read_dump(read_lines('sample_dump.txt'))
+        self.assertEqual(step, 256)
+        self.assertEqual(counts, {0x0000: 40, 0x0100: 100, 0x0200: 30, 0x0300: 10})
+        self.assertEqual(outside, 3)
+
+    def test_buckets_split_by_overlap(self):
+        functions = tinyprof.read_functions(fixture('sample.sym'))
+        step, counts, outside = tinyprof.read_dump(read_lines('sample_dump.txt'))
+        samples = tinyprof.attribute(functions, step, counts)
+        self.assertEqual(samples, {
+            '__vectors': 40 * 0x68 / 256.0,
+            'main': 40 * 0x98 / 256.0,
+            'loop': 50.0,
+            'helper': 25.0,
+            '(unknown)': 25.0,
+            '__vector_5': 40.0,
+        })
+
+    def test_report(self):
+        functions = tinyprof.read_functions(fixture('sample.sym'))
+        step, counts, outside = tinyprof.read_dump(read_lines('sample_dump.txt'))
+        out = StringIO()
+        tinyprof.report(out, functions, step, counts, outside)
+        self.assertEqual(out.getvalue(), ''.join(read_lines('sample_report.txt')))
+
+    def test_different_ranges(self):
+        lines = read_lines('sample_dump.txt')
+        lines.append('#profile first=0x0100 step=2 buckets=32 outside=0\n')
+        self.assertRaises(ValueError, tinyprof.read_dump, lines)
+
+    def test_no_dump(self):
+        self.assertRaises(ValueError, tinyprof.read_dump, ['free=312\n'])
+
+
+if __name__ == '__main__':
+    unittest.main()
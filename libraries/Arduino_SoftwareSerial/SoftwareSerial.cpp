@@ -155,9 +155,7 @@ const int XMIT_START_ADJUSTMENT = 6;
 // Statics
 //
 SoftwareSerial *SoftwareSerial::active_object = 0;
-char SoftwareSerial::_receive_buffer[_SS_MAX_RX_BUFF]; 
-volatile uint8_t SoftwareSerial::_receive_buffer_tail = 0;
-volatile uint8_t SoftwareSerial::_receive_buffer_head = 0;
+RingBuffer<_SS_MAX_RX_BUFF> SoftwareSerial::_receive_buffer;
 
 //
 // Debugging
@@ -205,7 +203,7 @@ bool SoftwareSerial::listen()
     _buffer_overflow = false;
     uint8_t oldSREG = SREG;
     cli();
-    _receive_buffer_head = _receive_buffer_tail = 0;
+    _receive_buffer.clear();
     active_object = this;
     SREG = oldSREG;
     return true;
@@ -266,13 +264,7 @@ void SoftwareSerial::recv()
       d = ~d;
 
     // if buffer full, set the overflow flag and return
-    if ((_receive_buffer_tail + 1) % _SS_MAX_RX_BUFF != _receive_buffer_head) 
-    {
-      // save new data in buffer: tail points to where byte goes
-      _receive_buffer[_receive_buffer_tail] = d; // save new byte
-      _receive_buffer_tail = (_receive_buffer_tail + 1) % _SS_MAX_RX_BUFF;
-    } 
-    else 
+    if (!_receive_buffer.push(d)) 
     {
 #if _DEBUG // for scope: pulse pin as overflow indictator
       DebugPulse(_DEBUG_PIN1, 1);
@@ -323,14 +315,25 @@ inline void SoftwareSerial::handle_interrupt()
   }
 }
 
-#if defined(PCINT0_vect)
+#if defined(PCINT0_HANDLER)
+// Arduino-Tiny: share the pin change vectors through the core's router
+PCINT0_HANDLER(INTERRUPT_SLOT_SERIAL, 0xFF)
+{
+  SoftwareSerial::handle_interrupt();
+}
+#elif defined(PCINT0_vect)
 ISR(PCINT0_vect)
 {
   SoftwareSerial::handle_interrupt();
 }
 #endif
 
-#if defined(PCINT1_vect)
+#if defined(PCINT1_HANDLER)
+PCINT1_HANDLER(INTERRUPT_SLOT_SERIAL, 0xFF)
+{
+  SoftwareSerial::handle_interrupt();
+}
+#elif defined(PCINT1_vect)
 ISR(PCINT1_vect)
 {
   SoftwareSerial::handle_interrupt();
@@ -447,14 +450,8 @@ int SoftwareSerial::read()
   if (!isListening())
     return -1;
 
-  // Empty buffer?
-  if (_receive_buffer_head == _receive_buffer_tail)
-    return -1;
-
-  // Read from "head"
-  uint8_t d = _receive_buffer[_receive_buffer_head]; // grab next byte
-  _receive_buffer_head = (_receive_buffer_head + 1) % _SS_MAX_RX_BUFF;
-  return d;
+  // -1 when the buffer is empty
+  return _receive_buffer.pop();
 }
 
 int SoftwareSerial::available()
@@ -462,7 +459,7 @@ int SoftwareSerial::available()
   if (!isListening())
     return 0;
 
-  return (_receive_buffer_tail + _SS_MAX_RX_BUFF - _receive_buffer_head) % _SS_MAX_RX_BUFF;
+  return _receive_buffer.available();
 }
 
 size_t SoftwareSerial::write(uint8_t b)
@@ -520,10 +517,8 @@ void SoftwareSerial::flush()
   if (!isListening())
     return;
 
-  uint8_t oldSREG = SREG;
-  cli();
-  _receive_buffer_head = _receive_buffer_tail = 0;
-  SREG = oldSREG;
+  // only the reading side's index moves, so no need for cli
+  _receive_buffer.clear();
 }
 
 int SoftwareSerial::peek()
@@ -531,10 +526,6 @@ int SoftwareSerial::peek()
   if (!isListening())
     return -1;
 
-  // Empty buffer?
-  if (_receive_buffer_head == _receive_buffer_tail)
-    return -1;
-
-  // Read from "head"
-  return _receive_buffer[_receive_buffer_head];
+  // -1 when the buffer is empty
+  return _receive_buffer.peek();
 }
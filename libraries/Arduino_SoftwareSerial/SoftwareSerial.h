@@ -34,6 +34,7 @@ http://arduiniana.org.
 
 #include <inttypes.h>
 #include <Stream.h>
+#include <RingBuffer.h>
 
 /******************************************************************************
 * Definitions
@@ -63,9 +64,7 @@ private:
   uint16_t _inverse_logic:1;
 
   // static data
-  static char _receive_buffer[_SS_MAX_RX_BUFF]; 
-  static volatile uint8_t _receive_buffer_tail;
-  static volatile uint8_t _receive_buffer_head;
+  static RingBuffer<_SS_MAX_RX_BUFF> _receive_buffer;
   static SoftwareSerial *active_object;
 
   // private methods
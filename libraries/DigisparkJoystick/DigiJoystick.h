@@ -190,6 +190,7 @@ class DigiJoystickDevice {
 	    milli -= now - last;
 	    last = now;
 	    update();
+	    if (milli > 1) idle(); // sleep until USB or the millis timer needs us
 	  }
 	}
 	
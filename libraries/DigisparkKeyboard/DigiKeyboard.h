@@ -15,6 +15,7 @@
 
 #include "usbdrv.h"
 #include "scancode-ascii-table.h"
+#include "RingBuffer.h"
 
 // TODO: Work around Arduino 12 issues better.
 //#include <WConstants.h>
@@ -23,19 +24,24 @@
 typedef uint8_t byte;
 
 
-#define BUFFER_SIZE 2 // Minimum of 2: 1 for modifiers + 1 for keystroke 
+#define BUFFER_SIZE 8 // Boot keyboard report: modifiers, reserved, 6 keys
+
+// Keystrokes waiting to be typed, two bytes each (key then modifiers);
+// a power of 2 up to 128
+#ifndef DIGIKEYBOARD_FIFO_SIZE
+#define DIGIKEYBOARD_FIFO_SIZE 32
+#endif
 
 
 static uchar    idleRate;           // in 4 ms units 
 
 
-/* We use a simplifed keyboard report descriptor which does not support the
- * boot protocol. We don't allow setting status LEDs and but we do allow
- * simultaneous key presses. 
+/* The report is the 8 byte boot protocol one: a modifier byte, a reserved
+ * byte and up to 6 keys held at once. We don't allow setting status LEDs.
  * The report descriptor has been created with usb.org's "HID Descriptor Tool"
  * which can be downloaded from http://www.usb.org/developers/hidpage/.
  * Redundant entries (such as LOGICAL_MINIMUM and USAGE_PAGE) have been omitted
- * for the second INPUT item.
+ * for the later INPUT items.
  */
 PROGMEM char usbHidReportDescriptor[USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH] = { /* USB report descriptor */
   0x05, 0x01,                    // USAGE_PAGE (Generic Desktop) 
@@ -49,8 +55,10 @@ PROGMEM char usbHidReportDescriptor[USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH] = { /*
   0x75, 0x01,                    //   REPORT_SIZE (1) 
   0x95, 0x08,                    //   REPORT_COUNT (8) 
   0x81, 0x02,                    //   INPUT (Data,Var,Abs) 
-  0x95, 0x01,           //   REPORT_COUNT (simultaneous keystrokes) 
+  0x95, 0x01,                    //   REPORT_COUNT (1) 
   0x75, 0x08,                    //   REPORT_SIZE (8) 
+  0x81, 0x01,                    //   INPUT (Cnst,Ary,Abs) 
+  0x95, 0x06,                    //   REPORT_COUNT (simultaneous keystrokes) 
   0x25, 0x65,                    //   LOGICAL_MAXIMUM (101) 
   0x19, 0x00,                    //   USAGE_MINIMUM (Reserved (no event indicated)) 
   0x29, 0x65,                    //   USAGE_MAXIMUM (Keyboard Application) 
@@ -128,6 +136,8 @@ PROGMEM char usbHidReportDescriptor[USB_CFG_HID_REPORT_DESCRIPTOR_LENGTH] = { /*
 
 #define KEY_ARROW_LEFT 0x50
 
+#define KEY_JOINED  0x80    // in the key queue only, see sendKeyStrokes
+
 
 class DigiKeyboardDevice : public Print {
  public:
@@ -146,10 +156,15 @@ class DigiKeyboardDevice : public Print {
     //       missing first keystroke bug properly.
     memset(reportBuffer, 0, sizeof(reportBuffer));      
     usbSetInterrupt(reportBuffer, sizeof(reportBuffer));
+    pendingValid = 0;
   }
     
+  // Keystrokes are queued and typed from here, one report each time the
+  // host has collected the last one
   void update() {
     usbPoll();
+    if (usbInterruptIsReady())
+      sendNextReport();
   }
 	
 	// delay while updating until we are finished delaying
@@ -160,40 +175,38 @@ class DigiKeyboardDevice : public Print {
 	    milli -= now - last;
 	    last = now;
 	    update();
+	    if (milli > 1) idle(); // sleep until USB or the millis timer needs us
 	  }
 	}
   
+  // Returns once everything queued has been typed and the keys let go
+  void flush() {
+    while (!keyFifo.isEmpty() || pendingValid || reportBuffer[0] || reportBuffer[2] || !usbInterruptIsReady())
+      update();
+  }
+  
   void sendKeyStroke(byte keyStroke) {
     sendKeyStroke(keyStroke, 0);
   }
 
+  // Queues the keystroke; only waits (updating) when the queue is full
   void sendKeyStroke(byte keyStroke, byte modifiers) {
-   	while (!usbInterruptIsReady()) {
-      // Note: We wait until we can send keystroke
-      //       so we know the previous keystroke was
-      //       sent.
-    	usbPoll();
-    	_delay_ms(5);
-    }
-    
-    memset(reportBuffer, 0, sizeof(reportBuffer));
-		
-    reportBuffer[0] = modifiers;
-    reportBuffer[1] = keyStroke;
-    
-    usbSetInterrupt(reportBuffer, sizeof(reportBuffer));
-		
-  	while (!usbInterruptIsReady()) {
-      // Note: We wait until we can send keystroke
-      //       so we know the previous keystroke was
-      //       sent.
-    	usbPoll();
-    	_delay_ms(5);
+    sendKeyStrokes(&keyStroke, 1, modifiers);
+  }
+
+  // Up to 6 keys pressed together and then let go, like a chord
+  void sendKeyStrokes(const byte *keyStrokes, byte count, byte modifiers) {
+    byte i;
+
+    if (count > 6) count = 6;
+    if (count == 0) return;
+    while (keyFifo.room() < 2 * count)
+      update();
+    for (i = 0; i < count; i++) {
+      // bit 7 joins the key to the one before (key codes stop at 101)
+      keyFifo.push(i ? keyStrokes[i] | KEY_JOINED : keyStrokes[i]);
+      keyFifo.push(modifiers);
     }
-      
-    // This stops endlessly repeating keystrokes:
-    memset(reportBuffer, 0, sizeof(reportBuffer));      
-    usbSetInterrupt(reportBuffer, sizeof(reportBuffer));
   }
   
   size_t write(uint8_t chr) {
@@ -203,8 +216,54 @@ class DigiKeyboardDevice : public Print {
   }
     
   //private: TODO: Make friend?
-  uchar    reportBuffer[2];    // buffer for HID reports [ 1 modifier byte + (len-1) key strokes]
+  uchar    reportBuffer[BUFFER_SIZE]; // buffer for HID reports [ modifiers, reserved, 6 key strokes ]
   using Print::write;
+
+ private:
+  RingBuffer<DIGIKEYBOARD_FIFO_SIZE> keyFifo;
+  uchar    pendingModifiers;   // taken from keyFifo but not sent yet
+  uchar    pendingKey;
+  uchar    pendingValid;
+
+  uchar nextIsJoined() {
+    int key = keyFifo.peek();
+    return key >= 0 && (key & KEY_JOINED);
+  }
+
+  /* Each keystroke goes out as one report that also lets go of the key
+   * before it, so text is typed at one character per interrupt poll.  A
+   * report with nothing pressed is sent in between only when a key comes
+   * again while still held, the modifiers change or a chord starts or
+   * ends, and once the queue runs dry.
+   */
+  void sendNextReport() {
+    uchar held = reportBuffer[0] || reportBuffer[2];
+    uchar i;
+
+    if (!pendingValid && keyFifo.available() >= 2) {
+      pendingKey = keyFifo.pop();
+      pendingModifiers = keyFifo.pop();
+      pendingValid = 1;
+    }
+
+    if (pendingValid && !(held && (pendingModifiers != reportBuffer[0] || pendingKey == reportBuffer[2] ||
+                                   reportBuffer[3] || nextIsJoined()))) {
+      memset(reportBuffer, 0, sizeof(reportBuffer));
+      reportBuffer[0] = pendingModifiers;
+      reportBuffer[2] = pendingKey;
+      pendingValid = 0;
+      for (i = 3; i < sizeof(reportBuffer) && nextIsJoined(); i++) {
+        reportBuffer[i] = keyFifo.pop() & ~KEY_JOINED;
+        keyFifo.pop();
+      }
+    } else if (held) {
+      // This stops endlessly repeating keystrokes:
+      memset(reportBuffer, 0, sizeof(reportBuffer));
+    } else {
+      return;
+    }
+    usbSetInterrupt(reportBuffer, sizeof(reportBuffer));
+  }
 };
 
 DigiKeyboardDevice DigiKeyboard = DigiKeyboardDevice();
@@ -224,8 +283,7 @@ extern "C"{
 				/* wValue: ReportType (highbyte), ReportID (lowbyte) */
 
 				/* we only have one report type, so don't look at wValue */
-        // TODO: Ensure it's okay not to return anything here?    
-				return 0;
+				return sizeof(DigiKeyboard.reportBuffer);
 
       } else if (rq->bRequest == USBRQ_HID_GET_IDLE) {
 				//usbMsgPtr = &idleRate;
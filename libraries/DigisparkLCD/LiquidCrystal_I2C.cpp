@@ -230,6 +230,37 @@ inline size_t LiquidCrystal_I2C::write(uint8_t value) {
 	return 0;
 }
 
+// Characters per I2C transaction.  Each one is six expander bytes and the
+// TinyWireM buffer holds 15 after the address.
+#define LCD_CHARS_PER_TRANSMISSION 2
+
+// A run of characters is sent as a few long transactions rather than six
+// transactions per character.  At 100 kHz each expander byte takes longer
+// than the enable pulse and the settle time so no delays are needed.
+size_t LiquidCrystal_I2C::write(const uint8_t *buffer, size_t size) {
+	size_t count = size;
+	uint8_t i;
+
+	while (count) {
+#if defined(__AVR_ATtiny85__) || (__AVR_ATtiny2313__)
+		TinyWireM.beginTransmission(_Addr);
+#else
+		Wire.beginTransmission(_Addr);
+#endif
+		for (i = 0; i < LCD_CHARS_PER_TRANSMISSION && count; ++i, --count) {
+			queueNibble((*buffer & 0xf0) | Rs);
+			queueNibble(((*buffer << 4) & 0xf0) | Rs);
+			++buffer;
+		}
+#if defined(__AVR_ATtiny85__) || (__AVR_ATtiny2313__)
+		TinyWireM.endTransmission();
+#else
+		Wire.endTransmission();
+#endif
+	}
+	return size;
+}
+
 
 
 
@@ -261,6 +292,20 @@ void LiquidCrystal_I2C::expanderWrite(uint8_t _data){
 #endif
 	}
 
+// the same three expander writes as write4bits, added to the open transaction
+void LiquidCrystal_I2C::queueNibble(uint8_t _data){
+	uint8_t data = _data | _backlightval;
+#if defined(__AVR_ATtiny85__) || (__AVR_ATtiny2313__)
+	TinyWireM.send(data);
+	TinyWireM.send(data | En);	// En high
+	TinyWireM.send(data & ~En);	// En low
+#else
+	Wire.write(data);
+	Wire.write(data | En);
+	Wire.write(data & ~En);
+#endif
+}
+
 void LiquidCrystal_I2C::pulseEnable(uint8_t _data){
 	expanderWrite(_data | En);	// En high
 	delayMicroseconds(1);		// enable pulse must be >450ns
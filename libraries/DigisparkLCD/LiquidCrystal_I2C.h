@@ -92,6 +92,8 @@ public:
 #else
   virtual void write(uint8_t);
 #endif
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  using Print::write;
   void command(uint8_t);
   void init();
 
@@ -121,6 +123,7 @@ private:
   void send(uint8_t, uint8_t);
   void write4bits(uint8_t);
   void expanderWrite(uint8_t);
+  void queueNibble(uint8_t);
   void pulseEnable(uint8_t);
   uint8_t _Addr;
   uint8_t _displayfunction;
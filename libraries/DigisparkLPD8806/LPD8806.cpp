@@ -43,10 +43,11 @@ void LPD8806::updatePins(uint8_t dpin, uint8_t cpin) {
 void LPD8806::startBitbang() {
   pinMode(datapin, OUTPUT);
   pinMode(clkpin , OUTPUT);
-  *dataport &= ~datapinmask; // Data is held low throughout (latch = 0)
+  portClearReg(dataport, datapinmask); // Data is held low throughout (latch = 0)
+  portClearReg(clkport, clkpinmask);   // Clock idles low, so each toggle pair is a rising then falling edge
   for(uint8_t i = 8; i>0; i--) {
-    *clkport |=  clkpinmask;
-    *clkport &= ~clkpinmask;
+    portToggleReg(clkport, clkpinmask);
+    portToggleReg(clkport, clkpinmask);
   }
 }
 
@@ -77,10 +78,11 @@ void LPD8806::show(void) {
 
   for (i=0; i<n3; i++ ) {
     for (uint8_t bit=0x80; bit; bit >>= 1) {
-      if(pixels[i] & bit) *dataport |=  datapinmask;
-      else                *dataport &= ~datapinmask;
-      *clkport |=  clkpinmask;
-      *clkport &= ~clkpinmask;
+      // masked writes so an interrupt changing another pin on the port
+      // (V-USB, for one) is never undone
+      portWriteReg(dataport, datapinmask, (pixels[i] & bit) ? datapinmask : 0);
+      portToggleReg(clkport, clkpinmask);
+      portToggleReg(clkport, clkpinmask);
     }
   }
 
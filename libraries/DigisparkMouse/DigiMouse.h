@@ -37,21 +37,34 @@ static uchar rt_usbDeviceDescriptorSize = 0;
 
 typedef uint8_t byte;
 
-/* What was most recently read from the controller */
+/* What was most recently read from the controller; the motion bytes are
+ * only filled in from the pending counts when a report is built */
 static unsigned char last_built_report[REPORT_SIZE];
 
+/* Motion asked for but not sent yet.  Moves add up here (saturating) so
+ * none are lost between reports, and anything over 127 goes out over as
+ * many reports as it takes. */
+static int pending_x;
+static int pending_y;
+static int pending_scroll;
+
 /* What was most recently sent to the host */
 static unsigned char last_sent_report[REPORT_SIZE];
 
 uchar		 reportBuffer[REPORT_SIZE];
 
-// report frequency set to default of 50hz
-#define DIGIMOUSE_DEFAULT_REPORT_INTERVAL 20
+// unchanged report repeated at a default of 50hz, until the host says otherwise
+#define DIGIMOUSE_DEFAULT_IDLE_INTERVAL 20
 static unsigned char must_report = 0;
-static unsigned char idle_rate = DIGIMOUSE_DEFAULT_REPORT_INTERVAL / 4; // in units of 4ms
+static unsigned char idle_rate = DIGIMOUSE_DEFAULT_IDLE_INTERVAL / 4; // in units of 4ms, 0 for never
 // new minimum report frequency system:
 static unsigned long last_report_time = 0;
 
+// the host can't be asked to poll a low speed device more often than this
+#define DIGIMOUSE_MIN_REPORT_INTERVAL USB_CFG_INTR_POLL_INTERVAL
+// least ms between reports carrying motion; 0 for every poll
+static unsigned char report_interval = 0;
+
 
 
 PROGMEM unsigned char mouse_usbHidReportDescriptor[] = { /* USB report descriptor */
@@ -119,7 +132,30 @@ unsigned char usbDescrDevice[] PROGMEM = {		/* USB device descriptor */
 };
 
 
+void addMotion(int *pending, char delta) {
+	// saturate rather than wrap (int is 16 bits)
+	if (delta > 0 && *pending > 32767 - delta) {
+		*pending = 32767;
+	} else if (delta < 0 && *pending < -32767 - delta) {
+		*pending = -32767;
+	} else {
+		*pending += delta;
+	}
+}
+
+unsigned char takeMotion(int *pending) {
+	int delta = *pending;
+	if (delta > 127) delta = 127;
+	if (delta < -127) delta = -127;
+	*pending -= delta;
+	return (unsigned char)delta;
+}
+
 void buildReport(unsigned char *reportBuf) {
+	last_built_report[1] = takeMotion(&pending_x);
+	last_built_report[2] = takeMotion(&pending_y);
+	last_built_report[3] = takeMotion(&pending_scroll);
+
 	if (reportBuf != NULL) {
 		memcpy(reportBuf, last_built_report, REPORT_SIZE);
 	}
@@ -175,21 +211,27 @@ class DigiMouseDevice {
 		usbPoll();
 		
 		// instead of above code, use millis arduino system to enforce minimum reporting frequency
-		unsigned long time_since_last_report = millis() - last_report_time;
-		if (time_since_last_report >= (idle_rate * 4 /* in units of 4ms - usb spec stuff */)) {
-			last_report_time += idle_rate * 4;
+		unsigned long now = millis();
+		unsigned long time_since_last_report = now - last_report_time;
+		if (idle_rate != 0 && time_since_last_report >= (idle_rate * 4 /* in units of 4ms - usb spec stuff */)) {
 			must_report = 1;
 		}
 		
-		// if the report has changed, try force an update anyway
+		// if the buttons have changed, try force an update anyway
 		if (memcmp(last_built_report, last_sent_report, REPORT_SIZE)) {
 			must_report = 1;
 		}
 		
+		// motion goes out as soon as the report interval allows
+		if ((pending_x || pending_y || pending_scroll) && time_since_last_report >= report_interval) {
+			must_report = 1;
+		}
+		
 		// if we want to send a report, signal the host computer to ask us for it with a usb 'interrupt'
 		if (must_report) {
 			if (usbInterruptIsReady()) {
 				must_report = 0;
+				last_report_time = now;
 				buildReport(reportBuffer); // put data into reportBuffer
 				clearMove(); // clear deltas
 				usbSetInterrupt(reportBuffer, REPORT_SIZE);
@@ -205,39 +247,44 @@ class DigiMouseDevice {
 	    milli -= now - last;
 	    last = now;
 	    update();
+	    if (milli > 1) idle(); // sleep until USB or the millis timer needs us
 	  }
 	}
 	
+	// moves add to whatever hasn't been sent yet
 	void moveX(char deltaX)	{
-		if (deltaX == -128) deltaX = -127;
-		last_built_report[1] = *(reinterpret_cast<unsigned char *>(&deltaX));
+		addMotion(&pending_x, deltaX);
 	}
 	
 	void moveY(char deltaY) {
-		if (deltaY == -128) deltaY = -127;
-		last_built_report[2] = *(reinterpret_cast<unsigned char *>(&deltaY));
+		addMotion(&pending_y, deltaY);
 	}
 	
 	void scroll(char deltaS)	{
-		if (deltaS == -128) deltaS = -127;
-		last_built_report[3] = *(reinterpret_cast<unsigned char *>(&deltaS));	 
+		addMotion(&pending_scroll, deltaS);
 	}
 	
 	void move(char deltaX, char deltaY, char deltaS) {
-		if (deltaX == -128) deltaX = -127;
-		if (deltaY == -128) deltaY = -127;
-		if (deltaS == -128) deltaS = -127;
-		last_built_report[1] = *(reinterpret_cast<unsigned char *>(&deltaX));
-		last_built_report[2] = *(reinterpret_cast<unsigned char *>(&deltaY));
-		last_built_report[3] = *(reinterpret_cast<unsigned char *>(&deltaS));
+		addMotion(&pending_x, deltaX);
+		addMotion(&pending_y, deltaY);
+		addMotion(&pending_scroll, deltaS);
 	}
 	
 	void setButtons(unsigned char buttons) {
 		last_built_report[0] = buttons;
 	}
 	
+	// buttons, then X, Y and scroll moves
 	void setValues(unsigned char values[]) {
-		memcpy(last_built_report, values, REPORT_SIZE);
+		setButtons(values[0]);
+		move((char)values[1], (char)values[2], (char)values[3]);
+	}
+	
+	// Least time between reports that carry motion.  Anything up to
+	// DIGIMOUSE_MIN_REPORT_INTERVAL (10ms, the fastest a low speed device
+	// can be polled) sends at every poll; more spreads the motion out.
+	void setReportInterval(unsigned char milli) {
+		report_interval = (milli > DIGIMOUSE_MIN_REPORT_INTERVAL) ? milli : 0;
 	}
 	
 	//private: TODO: Make friend?
@@ -12,7 +12,7 @@
 #define BLUE_CLEAR (pinlevelB &= ~(1 << BLUE)) // map BLUE to PB2
 #define GREEN_CLEAR (pinlevelB &= ~(1 << GREEN)) // map BLUE to PB2
 #define RED_CLEAR (pinlevelB &= ~(1 << RED)) // map BLUE to PB2
-#define PORTB_MASK  (1 << PB0) | (1 << PB1) | (1 << PB2)
+#define PORTB_MASK  ((1 << PB0) | (1 << PB1) | (1 << PB2))
 #define BLUE PB2
 #define GREEN PB1
 #define RED PB0
@@ -60,7 +60,7 @@ ISR (TIM0_OVF_vect) {
   static unsigned char pinlevelB=PORTB_MASK;
   static unsigned char softcount=0xFF;
 
-  PORTB = pinlevelB;            // update outputs
+  portWrite(PORT_B_ID, PORTB_MASK, pinlevelB); // update outputs, leave the USB pins alone
   
   if(++softcount == 0){         // increment modulo 256 counter and update
                                 // the compare values only when counter = 0.
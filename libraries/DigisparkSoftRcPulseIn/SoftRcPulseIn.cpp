@@ -129,12 +129,12 @@ SoftRcPulseIn *RcPulseIn;
 	  if(digitalRead(RcPulseIn->_Pin))
 	  {
 		  /* High level, rising edge: start chrono */
-		  RcPulseIn->_Start_us = micros();
+		  RcPulseIn->_Start_us = micros16();
 	  }
 	  else
 	  {
 		  /* Low level, falling edge: stop chrono */
-		  RcPulseIn->_Width_us = micros() - RcPulseIn->_Start_us;
+		  RcPulseIn->_Width_us = micros16() - RcPulseIn->_Start_us;
 		  RcPulseIn->_Available = 1;
 #ifdef SOFT_RC_PULSE_IN_TIMEOUT_SUPPORT
 		  RcPulseIn->_LastTimeStampMs = (uint8_t)(millis() & 0x000000FF);
@@ -50,8 +50,8 @@ class SoftRcPulseIn : public RcRxPop
 	uint8_t _VirtualPortIdx;
 	uint16_t _Min_us;
 	uint16_t _Max_us;
-	uint32_t _Start_us;
-	uint32_t _Width_us;
+	uint16_t _Start_us;
+	uint16_t _Width_us;
 	boolean  _Available;
 #ifdef SOFT_RC_PULSE_IN_TIMEOUT_SUPPORT
 	uint8_t _LastTimeStampMs;
@@ -164,9 +164,7 @@ const int XMIT_START_ADJUSTMENT = 6;
 // Statics
 //
 SoftSerial *SoftSerial::active_object = 0;
-char SoftSerial::_receive_buffer[_SS_MAX_RX_BUFF]; 
-volatile uint8_t SoftSerial::_receive_buffer_tail = 0;
-volatile uint8_t SoftSerial::_receive_buffer_head = 0;
+RingBuffer<_SS_MAX_RX_BUFF> SoftSerial::_receive_buffer;
 
 //
 // Debugging
@@ -222,7 +220,7 @@ bool SoftSerial::listen()
     _buffer_overflow = false;
     uint8_t oldSREG = SREG;
     cli();
-    _receive_buffer_head = _receive_buffer_tail = 0;
+    _receive_buffer.clear();
     active_object = this;
     SREG = oldSREG;
     return true;
@@ -283,13 +281,7 @@ void SoftSerial::recv()
       d = ~d;
 
     // if buffer full, set the overflow flag and return
-    if ((_receive_buffer_tail + 1) % _SS_MAX_RX_BUFF != _receive_buffer_head) 
-    {
-      // save new data in buffer: tail points to where byte goes
-      _receive_buffer[_receive_buffer_tail] = d; // save new byte
-      _receive_buffer_tail = (_receive_buffer_tail + 1) % _SS_MAX_RX_BUFF;
-    } 
-    else 
+    if (!_receive_buffer.push(d)) 
     {
 #if _DEBUG // for scope: pulse pin as overflow indictator
       DebugPulse(_DEBUG_PIN1, 1);
@@ -469,14 +461,8 @@ int SoftSerial::read()
   if (!isListening())
     return -1;
 
-  // Empty buffer?
-  if (_receive_buffer_head == _receive_buffer_tail)
-    return -1;
-
-  // Read from "head"
-  uint8_t d = _receive_buffer[_receive_buffer_head]; // grab next byte
-  _receive_buffer_head = (_receive_buffer_head + 1) % _SS_MAX_RX_BUFF;
-  return d;
+  // -1 when the buffer is empty
+  return _receive_buffer.pop();
 }
 
 int SoftSerial::available()
@@ -484,7 +470,7 @@ int SoftSerial::available()
   if (!isListening())
     return 0;
 
-  return (_receive_buffer_tail + _SS_MAX_RX_BUFF - _receive_buffer_head) % _SS_MAX_RX_BUFF;
+  return _receive_buffer.available();
 }
 
 size_t SoftSerial::write(uint8_t b)
@@ -494,6 +480,25 @@ size_t SoftSerial::write(uint8_t b)
     return 0;
   }
 
+  tx_byte(b);
+  return 1;
+}
+
+// Interrupts are still only held off for one character at a time
+size_t SoftSerial::write(const uint8_t *buffer, size_t size)
+{
+  if (_tx_delay == 0) {
+    setWriteError();
+    return 0;
+  }
+
+  for (size_t n = size; n; --n)
+    tx_byte(*buffer++);
+  return size;
+}
+
+void SoftSerial::tx_byte(uint8_t b)
+{
   uint8_t oldSREG = SREG;
   cli();  // turn off interrupts for a clean txmit
 
@@ -533,8 +538,6 @@ size_t SoftSerial::write(uint8_t b)
 
   SREG = oldSREG; // turn interrupts back on
   tunedDelay(_tx_delay);
-  
-  return 1;
 }
 
 void SoftSerial::flush()
@@ -542,10 +545,8 @@ void SoftSerial::flush()
   if (!isListening())
     return;
 
-  uint8_t oldSREG = SREG;
-  cli();
-  _receive_buffer_head = _receive_buffer_tail = 0;
-  SREG = oldSREG;
+  // only the reading side's index moves, so no need for cli
+  _receive_buffer.clear();
 }
 
 int SoftSerial::peek()
@@ -553,12 +554,8 @@ int SoftSerial::peek()
   if (!isListening())
     return -1;
 
-  // Empty buffer?
-  if (_receive_buffer_head == _receive_buffer_tail)
-    return -1;
-
-  // Read from "head"
-  return _receive_buffer[_receive_buffer_head];
+  // -1 when the buffer is empty
+  return _receive_buffer.peek();
 }
 
 /* RC Navy: hack to use SofSerial as single wire bidirectional serial port */
@@ -40,6 +40,7 @@ http://arduiniana.org.
 
 #include <inttypes.h>
 #include <Stream.h>
+#include <RingBuffer.h>
 
 #include <TinyPinChange.h>
 
@@ -71,15 +72,14 @@ private:
   uint16_t _inverse_logic:1;
 
   // static data
-  static char _receive_buffer[_SS_MAX_RX_BUFF]; 
-  static volatile uint8_t _receive_buffer_tail;
-  static volatile uint8_t _receive_buffer_head;
+  static RingBuffer<_SS_MAX_RX_BUFF> _receive_buffer;
   static SoftSerial *active_object;
 
   // private methods
   void recv();
   uint8_t rx_pin_read();
   void tx_pin_write(uint8_t pin_state);
+  void tx_byte(uint8_t b);
   void setTX(uint8_t transmitPin);
   void setRX(uint8_t receivePin);
 
@@ -99,6 +99,7 @@ public:
   void txMode();
   void rxMode();
   virtual size_t write(uint8_t byte);
+  virtual size_t write(const uint8_t *buffer, size_t size);
   virtual int read();
   virtual int available();
   virtual void flush();
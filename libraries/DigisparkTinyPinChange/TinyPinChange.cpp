@@ -51,6 +51,21 @@ static void ExtInt3AsEmulatedPinChangeInt(void);
 /*************************************************************************
 							INTERRUPT SUB-ROUTINE
 *************************************************************************/
+#if defined(PCINT0_HANDLER)
+/* Arduino-Tiny: the vectors belong to the core's pin change router, so this library can share them */
+#define DECLARE_PIN_CHANGE_ISR(VirtualPortIdx)                                                                             \
+PCINT##VirtualPortIdx##_HANDLER(INTERRUPT_SLOT_PIN_CHANGE, 0xFF)                                                           \
+{                                                                                                                          \
+  uint8_t Idx;                                                                                                             \
+  PinChange.Port[VirtualPortIdx].PinCur  = now & (PC_PCMSK##VirtualPortIdx);                                               \
+  PinChange.Port[VirtualPortIdx].Event   = PinChange.Port[VirtualPortIdx].PinPrev ^ PinChange.Port[VirtualPortIdx].PinCur; \
+  PinChange.Port[VirtualPortIdx].PinPrev = PinChange.Port[VirtualPortIdx].PinCur;                                          \
+  for(Idx = 0; Idx < PinChange.Port[VirtualPortIdx].LoadedIsrNb; Idx++)                                                    \
+  {                                                                                                                        \
+    PinChange.Port[VirtualPortIdx].Isr[Idx]();                                                                             \
+  }                                                                                                                        \
+}
+#else
 #define DECLARE_PIN_CHANGE_ISR(VirtualPortIdx)                                                                             \
 ISR(PCINT##VirtualPortIdx##_vect)                                                                                          \
 {                                                                                                                          \
@@ -63,6 +78,7 @@ ISR(PCINT##VirtualPortIdx##_vect)
     PinChange.Port[VirtualPortIdx].Isr[Idx]();                                                                             \
   }                                                                                                                        \
 }
+#endif
 
 DECLARE_PIN_CHANGE_ISR(0)
 
@@ -149,7 +149,7 @@ void TinyPpmReaderClass::suspend(void)
 
 void TinyPpmReaderClass::resume(void)
 {
-  _PrevEdgeUs = (uint16_t)(micros() & 0xFFFF);
+  _PrevEdgeUs = micros16();
   TinyPinChange_EnablePin(_PpmFrameInputPin);
 }
 
@@ -162,7 +162,7 @@ void TinyPpmReaderClass::rcChannelCollectorIsr(void)
   
   if(TinyPinChange_RisingEdge(PpmReader->_VirtualPort, PpmReader->_PpmFrameInputPin))
   {
-    CurrentEdgeUs   = (uint16_t)(micros() & 0xFFFF);
+    CurrentEdgeUs   = micros16();
     PulseDurationUs = CurrentEdgeUs - PpmReader->_PrevEdgeUs;
     PpmReader->_PrevEdgeUs = CurrentEdgeUs;
     if(PulseDurationUs >= SYNCHRO_TIME_MIN_US)
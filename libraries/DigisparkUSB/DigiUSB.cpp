@@ -37,28 +37,9 @@ at least be connected to INT0 as well.
   #error "You must use Digispark (Tiny Core) board to use USB libraries"
 #endif
 
-// Ring buffer implementation nicked from HardwareSerial.cpp
-// TODO: Don't nick it. :)
-ring_buffer rx_buffer = { { 0 }, 0, 0 };
-ring_buffer tx_buffer = { { 0 }, 0, 0 };
+ring_buffer rx_buffer;
+ring_buffer tx_buffer;
 
-
-inline int store_char(unsigned char c, ring_buffer *the_buffer)
-{
-  int i = (the_buffer->head + 1) % RING_BUFFER_SIZE;
-
-  // if we should be storing the received character into the location
-  // just before the tail (meaning that the head would advance to the
-  // current location of the tail), we're about to overflow the buffer
-  // and so we don't write the character or advance the head.
-  if (i != the_buffer->tail) {
-    the_buffer->buffer[the_buffer->head] = c;
-    the_buffer->head = i;
-    return 1;
- }
-    return 0;
-  
-}
  
 DigiUSBDevice::DigiUSBDevice(ring_buffer *rx_buffer,
 				 ring_buffer *tx_buffer) {
@@ -88,8 +69,28 @@ void DigiUSBDevice::update() {
 }
 
 
+static uchar stream_enabled;   /* set by the host with DIGIUSB_RQ_STREAM */
+
+/* State of the chunked transfer in progress (see DigiUSB.h) */
+static uchar transfer_count;      /* ring bytes still to go */
+static uchar transfer_length;     /* bytes left in the data stage */
+static uchar transfer_first;      /* the count byte hasn't been handled */
+
 void DigiUSBDevice::refresh() {
   usbPoll();
+
+  // usbSetInterrupt copies the packet so it can live on the stack.  Not
+  // while a GET_REPORT is part way through: its count byte has gone out
+  // and the bytes it promised have to still be there for the next packets
+  if (stream_enabled && transfer_count == 0 && usbInterruptIsReady() && !tx_buffer.isEmpty()) {
+    uchar packet[8];
+    uchar n = tx_buffer.pop(packet, sizeof(packet));
+    usbSetInterrupt(packet, n);
+  }
+}
+
+bool DigiUSBDevice::streaming() {
+  return stream_enabled;
 }
 
 // wait a specified number of milliseconds (roughly), refreshing in the background
@@ -100,57 +101,45 @@ void DigiUSBDevice::delay(long milli) {
     milli -= now - last;
     last = now;
     refresh();
+    if (milli > 1) idle(); // sleep until USB or the millis timer needs us
   }
 }
 
 int DigiUSBDevice::available() {
   /*
    */
-  return (RING_BUFFER_SIZE + _rx_buffer->head - _rx_buffer->tail) % RING_BUFFER_SIZE;
+  return _rx_buffer->available();
 }
 
 int DigiUSBDevice::tx_remaining() {
-  return RING_BUFFER_SIZE - (RING_BUFFER_SIZE + _tx_buffer->head - _tx_buffer->tail) % RING_BUFFER_SIZE;
+  return _tx_buffer->room();
 }
   
 int DigiUSBDevice::read() {
   /*
    */
-  // if the head isn't ahead of the tail, we don't have any characters
-  if (_rx_buffer->head == _rx_buffer->tail) {
-    return -1;
-  } else {
-    unsigned char c = _rx_buffer->buffer[_rx_buffer->tail];
-    _rx_buffer->tail = (_rx_buffer->tail + 1) % RING_BUFFER_SIZE;
-    return c;
-  }
+  return _rx_buffer->pop();
 }
 
 size_t DigiUSBDevice::write(byte c) {
   /*
    */
-  return store_char(c, _tx_buffer);
+  return _tx_buffer->push(c);
+}
+
+// Anything that doesn't fit is dropped
+size_t DigiUSBDevice::write(const uint8_t *buffer, size_t size) {
+  return _tx_buffer->push(buffer, size);
 }
 
 
 // TODO: Handle this better?
 int tx_available() {
-  /*
-   */
-  return (RING_BUFFER_SIZE + tx_buffer.head - tx_buffer.tail) % RING_BUFFER_SIZE;
+  return tx_buffer.available();
 }
 
 int tx_read() {
-  /*
-   */
-  // if the head isn't ahead of the tail, we don't have any characters
-  if (tx_buffer.head == tx_buffer.tail) {
-    return -1;
-  } else {
-    unsigned char c = tx_buffer.buffer[tx_buffer.tail];
-    tx_buffer.tail = (tx_buffer.tail + 1) % RING_BUFFER_SIZE;
-    return c;
-  } 
+  return tx_buffer.pop();
 }
 
 
@@ -186,9 +175,20 @@ usbMsgLen_t usbFunctionSetup(uchar data[8])
 {
   usbRequest_t    *rq = (usbRequest_t*)((void *)data);
 
+    transfer_count = 0;   /* a new SETUP ends any transfer the host gave up on */
+
     if((rq->bmRequestType & USBRQ_TYPE_MASK) == USBRQ_TYPE_CLASS){    /* HID class request */
         if(rq->bRequest == USBRQ_HID_GET_REPORT){  /* wValue: ReportType (highbyte), ReportID (lowbyte) */
             /* since we have only one report type, we can ignore the report-ID */
+            if (rq->wLength.word > 1) {
+              /* count byte then data, filled in by usbFunctionRead */
+              int n = tx_available();
+              if (n > rq->wLength.word - 1)
+                n = rq->wLength.word - 1;
+              transfer_count = n;
+              transfer_first = 1;
+              return USB_NO_MSG;
+            }
 	    static uchar dataBuffer[1];  /* buffer must stay valid when usbFunctionSetup returns */
 	    if (tx_available()) {
 	      dataBuffer[0] = tx_read();
@@ -199,16 +199,66 @@ usbMsgLen_t usbFunctionSetup(uchar data[8])
 	    }
         }else if(rq->bRequest == USBRQ_HID_SET_REPORT){
             /* since we have only one report type, we can ignore the report-ID */
+            if (rq->wLength.word > 0) {
+              /* count byte then data, taken by usbFunctionWrite */
+              transfer_length = rq->wLength.word;
+              transfer_first = 1;
+              return USB_NO_MSG;
+            }
 
-	  // TODO: Check race issues?
-	  store_char(rq->wIndex.bytes[0], &rx_buffer);
+	  rx_buffer.push(rq->wIndex.bytes[0]);
 
         }
-    }else{
-        /* ignore vendor type requests, we don't use any */
+    }else if((rq->bmRequestType & USBRQ_TYPE_MASK) == USBRQ_TYPE_VENDOR){
+        if(rq->bRequest == DIGIUSB_RQ_INFO){
+            static uchar info[4];
+            info[0] = DIGIUSB_PROTOCOL_VERSION;
+            info[1] = RING_BUFFER_SIZE;
+            info[2] = rx_buffer.room();
+            info[3] = tx_available();
+            usbMsgPtr = info;
+            return sizeof(info);
+        }
+        else if(rq->bRequest == DIGIUSB_RQ_STREAM){
+            stream_enabled = rq->wValue.bytes[0];
+        }
     }
     return 0;
 }
+
+uchar usbFunctionRead(uchar *data, uchar len)
+{
+  uchar i = 0;
+  uchar n;
+
+  if (transfer_first) {
+    data[i++] = transfer_count;
+    transfer_first = 0;
+  }
+  n = tx_buffer.pop(data + i, (len - i < transfer_count) ? len - i : transfer_count);
+  transfer_count -= n;
+  i += n;
+  /* a short packet ends the transfer */
+  return i;
+}
+
+uchar usbFunctionWrite(uchar *data, uchar len)
+{
+  uchar i = 0;
+  uchar n;
+
+  if (transfer_first) {
+    transfer_count = data[i++];
+    transfer_first = 0;
+  }
+  n = (len - i < transfer_count) ? len - i : transfer_count;
+  rx_buffer.push(data + i, n);
+  transfer_count -= n;
+
+  /* 1 once the whole data stage is in, padding and all */
+  transfer_length = (len < transfer_length) ? transfer_length - len : 0;
+  return transfer_length == 0;
+}
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -11,6 +11,7 @@
 #include <string.h>
 #include "usbdrv.h"
 #include "Print.h"
+#include "RingBuffer.h"
 
 
 typedef uint8_t byte;
@@ -19,11 +20,50 @@ typedef uint8_t byte;
 
 #define RING_BUFFER_SIZE 128
 
+/* Host protocol.
+ *
+ * The original tools move one byte per control transfer: a HID
+ * GET_REPORT with wLength 1 returns the next byte from the device, and a
+ * SET_REPORT with no data stage carries one byte in the low byte of
+ * wIndex.  Both still work.
+ *
+ * A host that sends the vendor request DIGIUSB_RQ_INFO (device-to-host,
+ * wLength 4) gets back DIGIUSB_PROTOCOL_VERSION, RING_BUFFER_SIZE, the
+ * free space in the receive ring and the bytes waiting in the transmit
+ * ring.  Older firmware ignores the request and returns nothing, which
+ * tells the host to stay with single bytes.  Otherwise:
+ *
+ *   GET_REPORT with wLength > 1 returns a count byte followed by up to
+ *   wLength - 1 bytes from the transmit ring.
+ *
+ *   SET_REPORT with a data stage carries a count byte followed by that
+ *   many bytes for the receive ring; anything after them is ignored.
+ *   Bytes that don't fit in the ring are dropped, so keep to the free
+ *   space reported by DIGIUSB_RQ_INFO.
+ *
+ * Transfers can be up to 254 bytes long.
+ *
+ * The vendor request DIGIUSB_RQ_STREAM (host-to-device, no data) with
+ * wValue 1 turns on streaming: refresh() moves up to 8 bytes from the
+ * transmit ring into the interrupt-IN endpoint (0x81) whenever the last
+ * packet has been collected.  The packet length is the byte count.  wValue
+ * 0 turns it off again.  It is off after reset so an OS HID driver polling
+ * the endpoint can't take bytes meant for a control transfer tool.  It
+ * also pauses while a GET_REPORT is in progress, so the bytes that
+ * report's count byte promised are still there to send.
+ *
+ * The host polls every USB_CFG_INTR_POLL_INTERVAL ms (10, which most host
+ * controllers round down to 8 for a low-speed device), so streaming tops
+ * out near 8 bytes per poll, 800 to 1000 bytes a second, and a byte waits
+ * at most one poll interval plus the time between calls to refresh().
+ */
+#define DIGIUSB_PROTOCOL_VERSION  2
+#define DIGIUSB_RQ_INFO           0x01
+#define DIGIUSB_RQ_STREAM         0x02
+
 
-struct ring_buffer {
-  unsigned char buffer[RING_BUFFER_SIZE];
-  int head;
-  int tail;
+// The sketch fills tx and usbPoll drains it; the other way round for rx
+struct ring_buffer : public RingBuffer<RING_BUFFER_SIZE> {
 };
 
 
@@ -44,6 +84,7 @@ class DigiUSBDevice : public Print {
   void update();
 
   void refresh();
+  bool streaming();
   void delay(long milliseconds);
 
   int available();
@@ -51,6 +92,7 @@ class DigiUSBDevice : public Print {
   
   int read();
   virtual size_t write(byte c);
+  virtual size_t write(const uint8_t *buffer, size_t size);
   using Print::write;
 
 };
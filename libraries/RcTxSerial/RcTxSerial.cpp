@@ -40,24 +40,18 @@ RcTxSerial    *RcTxSerial::first = NULL;
 /* Constructor */
 RcTxSerial::RcTxSerial(RcTxPop *RcTxPop, uint8_t TxFifoSize, uint8_t Ch /* = 255 */)
 {
-#ifdef PPM_TX_SERIAL_USES_POWER_OF_2_AUTO_MALLOC
+  uint8_t  Size = 1;
+  uint8_t *Buffer;
+
   if(TxFifoSize > 128) TxFifoSize = 128; /* Must fit in a 8 bits  */
-  _TxFifoSize = 1;
-  do
-  {
-    _TxFifoSize <<= 1;
-  }while(_TxFifoSize < TxFifoSize); /* Search for the _TxFifoSize in power of 2 just greater or equal to requested size */
-#else
-  _TxFifoSize = TxFifoSize;
-#endif
-  _TxFifo = (char *)malloc(_TxFifoSize);
-  if(_TxFifo != NULL)
+  while(Size < TxFifoSize) Size <<= 1; /* Power of 2 just greater or equal to requested size: indexes are masked, the whole fifo is usable */
+  Buffer = (uint8_t *)malloc(Size);
+  _TxFifo.begin(Buffer, (Buffer != NULL)? Size: 0); /* No buffer: always full, writes are discarded */
+  if(Buffer != NULL)
   {
     _RcTxPop = RcTxPop;
     _Ch     = Ch;
     _TxCharInProgress = 0;
-    _TxFifoTail = 0;
-    _TxFifoHead = 0;
     next  = first;
     first = this;
   }
@@ -65,17 +59,13 @@ RcTxSerial::RcTxSerial(RcTxPop *RcTxPop, uint8_t TxFifoSize, uint8_t Ch /* = 255
 
 size_t RcTxSerial::write(uint8_t b)
 {
-  size_t Ret = 0;
+  // if buffer full (or not allocated), discard the character and return 0
+  return(_TxFifo.push(b));
+}
 
-  // if buffer full, discard the character and return
-  if ((_TxFifoTail + 1) % _TxFifoSize != _TxFifoHead)
-  {
-    // save new data in buffer: tail points to where byte goes
-    _TxFifo[_TxFifoTail] = b; // save new byte
-    _TxFifoTail = (_TxFifoTail + 1) % _TxFifoSize;
-    Ret = 1;
-  }
-  return(Ret);
+size_t RcTxSerial::write(const uint8_t *buffer, size_t size)
+{
+  return(_TxFifo.push(buffer, size)); /* Discard what doesn't fit */
 }
 
 int RcTxSerial::read()
@@ -90,17 +80,12 @@ int RcTxSerial::available()
 
 void RcTxSerial::flush()
 {
-  _TxFifoHead = _TxFifoTail = 0;
+  _TxFifo.clear();
 }
 
 int RcTxSerial::peek()
 {
-  // Empty buffer?
-  if (_TxFifoHead == _TxFifoTail)
-    return -1;
-
-  // Read from "head"
-  return _TxFifo[_TxFifoHead];
+  return _TxFifo.peek();
 }
 
 uint8_t RcTxSerial::process()
@@ -143,14 +128,9 @@ uint8_t RcTxSerial::process()
 //========================================================================================================================
 uint8_t RcTxSerial::TxFifoRead(char *TxChar)
 {
-uint8_t Ret = 0;
+int c = _TxFifo.pop();
   // Empty buffer?
-  if (_TxFifoHead != _TxFifoTail)
-  {
-    // Read from "head"
-    *TxChar = _TxFifo[_TxFifoHead]; // grab next byte
-    _TxFifoHead = (_TxFifoHead + 1) % _TxFifoSize;
-    Ret=1;
-  }
-  return(Ret);
+  if (c < 0) return(0);
+  *TxChar = c; // grab next byte
+  return(1);
 }
@@ -18,9 +18,7 @@
 
 #include <inttypes.h>
 #include <Stream.h>
-
-/* MODULE CONFIGURATION */
-//#define PPM_TX_SERIAL_USES_POWER_OF_2_AUTO_MALLOC /* Comment this if you set fifo size to a power of 2: this allows saving some bytes of program memory */
+#include <RingBuffer.h>
 
 enum {RC_TX_SERIAL_INIT_WITH_DEFAULT=0, RC_TX_SERIAL_INIT_WITH_CURRENT_EEPROM};
 
@@ -33,19 +31,17 @@ class RcTxSerial : public Stream
   private:
     // static data
     uint8_t  _Ch;
-    uint8_t  _TxFifoSize;
     boolean  _TxCharInProgress;
-    char    *_TxFifo;
+    ExternalRingBuffer _TxFifo; /* Over a malloc'ed buffer of the size given to the constructor */
     char     _TxChar;
-    uint8_t  _TxFifoTail;
-    uint8_t  _TxFifoHead;
     class    RcTxSerial *next;
     static   RcTxSerial *first;
     uint8_t  TxFifoRead(char *TxChar);
   public:
-    RcTxSerial(RcTxPop *RcTxPop, uint8_t TxFifoSize, uint8_t Ch = 255);
+    RcTxSerial(RcTxPop *RcTxPop, uint8_t TxFifoSize, uint8_t Ch = 255); /* TxFifoSize is rounded up to a power of 2 (128 max) */
     int peek();
     virtual size_t write(uint8_t byte);
+    virtual size_t write(const uint8_t *buffer, size_t size);
     virtual int read();
     virtual int available();
     virtual void flush();